@@ -191,6 +191,143 @@ ONESDK_DEFINE_INLINE_FUNCTION(void) onesdk_tracer_error(onesdk_tracer_handle_t t
 
 /*========================================================================================================================================*/
 
+/** @brief Enables the extended tracer functions of the loaded agent.
+
+    @return @ref ONESDK_SUCCESS if successful, an SDK stub error code otherwise.
+
+    Functions that apply caller-supplied timestamps (e.g. @ref onesdk_tracer_start_timed) need agent support that is
+    not enabled by @ref onesdk_initialize. An application that wants to use them should call this function once after each successful
+    call to @ref onesdk_initialize (or @ref onesdk_initialize_2), before using any of these functions. If the extended tracer functions
+    are not enabled, the functions using them fall back to capturing the current time.
+
+    @note This function is not thread-safe. Call it from the thread that initializes the SDK, before other threads use the SDK.
+*/
+ONESDK_DECLARE_FUNCTION(onesdk_result_t) onesdk_ex_api_enable_tracer_ext(void);
+
+/** @internal */
+ONESDK_DECLARE_FUNCTION(onesdk_bool_t) onesdk_ex_tracer_start_2(onesdk_tracer_handle_t tracer_handle, onesdk_tracer_handle_t parent_tracer_handle, onesdk_int64_t start_time_micro);
+
+/** @internal */
+ONESDK_DECLARE_FUNCTION(void) onesdk_ex_tracer_end_timed(onesdk_tracer_handle_t tracer_handle, onesdk_int64_t end_time_micro);
+
+/** @brief Starts a tracer with a caller-supplied start time.
+    @param tracer_handle    A valid tracer handle.
+    @param start_time       The start time in microseconds since the Unix epoch (1970-01-01T00:00:00Z).
+
+    @return A non-zero value if @p start_time was applied, zero if the tracer was started with the current time instead.
+
+    This function allows an application to take a cheap timestamp on a latency-critical thread when an operation begins and ends, and to
+    create, start and end the tracer later (e.g. from a background thread) with @ref onesdk_tracer_start_timed and
+    @ref onesdk_tracer_end_timed. The tracer is linked to the active tracer of the thread that calls this function, just like with
+    @ref onesdk_tracer_start.
+
+    The start time is only applied if the extended tracer functions have been enabled by calling @ref onesdk_ex_api_enable_tracer_ext
+    and an agent is active. Otherwise this function behaves like @ref onesdk_tracer_start and returns zero. In that case the application
+    must end the tracer with @ref onesdk_tracer_end, not with @ref onesdk_tracer_end_timed.
+
+    @code{.c}
+    onesdk_bool_t const timed = onesdk_tracer_start_timed(tracer, op->start_time);
+    ... set tracer attributes ...
+    if (timed)
+        onesdk_tracer_end_timed(tracer, op->end_time);
+    else
+        onesdk_tracer_end(tracer);
+    @endcode
+
+    @see @ref onesdk_tracer_start
+*/
+ONESDK_DEFINE_INLINE_FUNCTION(onesdk_bool_t) onesdk_tracer_start_timed(onesdk_tracer_handle_t tracer_handle, onesdk_int64_t start_time) {
+    if (onesdk_ex_tracer_start_2(tracer_handle, ONESDK_INVALID_HANDLE, start_time))
+        return 1;
+    onesdk_tracer_start(tracer_handle);
+    return 0;
+}
+
+/** @brief Ends and releases a tracer that was started by @ref onesdk_tracer_start_timed, using a caller-supplied end time.
+    @param tracer_handle    A valid tracer handle.
+    @param end_time         The end time in microseconds since the Unix epoch (1970-01-01T00:00:00Z).
+
+    Must only be used for tracers for which @ref onesdk_tracer_start_timed returned a non-zero value. After this function returns, the
+    tracer handle is invalid and must not be used anymore.
+
+    @see @ref onesdk_tracer_end
+*/
+ONESDK_DEFINE_INLINE_FUNCTION(void) onesdk_tracer_end_timed(onesdk_tracer_handle_t tracer_handle, onesdk_int64_t end_time) {
+    onesdk_ex_tracer_end_timed(tracer_handle, end_time);
+}
+
+/** @brief Starts a tracer as a child of an explicitly specified parent tracer.
+    @param tracer_handle            A valid tracer handle.
+    @param parent_tracer_handle     The handle of a started tracer that has not been ended yet, or @ref ONESDK_INVALID_HANDLE.
+
+    @return A non-zero value if the tracer was started as a child of @p parent_tracer_handle, zero if it was started by
+            @ref onesdk_tracer_start instead.
+
+    Like any other tracer, a tracer created by a `create` function is linked to its parent when it is started. Normally the parent is the
+    active tracer of the calling thread. This function uses @p parent_tracer_handle instead, so the agent doesn't have to look up the
+    active tracer of the thread. Code that already holds the parent's handle (e.g. a function that traces a request and the calls it
+    makes, or a background thread that submits recorded operations with @ref onesdk_tracer_start_timed_with_parent) can pass it
+    directly:
+
+    @code{.c}
+    void handle_request(request* req) {
+        onesdk_tracer_handle_t const request_tracer = onesdk_incomingwebrequesttracer_create(...);
+        onesdk_tracer_start(request_tracer);
+        for (i = 0; i < req->query_count; i++) {
+            onesdk_tracer_handle_t const tracer = onesdk_databaserequesttracer_create_sql(...);
+            onesdk_tracer_start_with_parent(tracer, request_tracer);
+            ...
+            onesdk_tracer_end(tracer);
+        }
+        onesdk_tracer_end(request_tracer);
+    }
+    @endcode
+
+    The parent must stay open until the child has been ended: it must have been started, and must not be ended before the child. Since
+    tracers are ended in reverse order of starting them on their thread, a parent tracer can't be kept open across the callbacks of an
+    event loop that serves other requests on the same thread in the meantime. To link the callbacks of an event loop to their request,
+    capture an in-process link while the request's tracer is active and start an in-process link tracer in each callback instead (see
+    @ref onesdk_inprocesslinktracer_create, or `onesdk::request_context` in C++).
+
+    After it was started, the tracer is the active tracer of the calling thread until it is ended, just like after
+    @ref onesdk_tracer_start. It is ended with @ref onesdk_tracer_end in either case.
+
+    The parent is only applied if the extended tracer functions have been enabled by calling @ref onesdk_ex_api_enable_tracer_ext and
+    an agent is active. Otherwise this function behaves like @ref onesdk_tracer_start and returns zero. If @p parent_tracer_handle is
+    @ref ONESDK_INVALID_HANDLE, the tracer is linked to the active tracer of the calling thread.
+
+    @see @ref onesdk_tracer_start_timed_with_parent
+*/
+ONESDK_DEFINE_INLINE_FUNCTION(onesdk_bool_t) onesdk_tracer_start_with_parent(onesdk_tracer_handle_t tracer_handle, onesdk_tracer_handle_t parent_tracer_handle) {
+    /* A start time of zero means the current time. */
+    if (onesdk_ex_tracer_start_2(tracer_handle, parent_tracer_handle, 0))
+        return 1;
+    onesdk_tracer_start(tracer_handle);
+    return 0;
+}
+
+/** @brief Starts a tracer as a child of an explicitly specified parent tracer, with a caller-supplied start time.
+    @param tracer_handle            A valid tracer handle.
+    @param parent_tracer_handle     The handle of a started tracer that has not been ended yet, or @ref ONESDK_INVALID_HANDLE.
+    @param start_time               The start time in microseconds since the Unix epoch (1970-01-01T00:00:00Z).
+
+    @return A non-zero value if the parent and @p start_time were applied, zero if the tracer was started by @ref onesdk_tracer_start
+            instead.
+
+    Combines @ref onesdk_tracer_start_with_parent and @ref onesdk_tracer_start_timed. If this function returned a non-zero value, the
+    tracer must be ended with @ref onesdk_tracer_end_timed, otherwise with @ref onesdk_tracer_end.
+
+    The parent must stay open until the child has been ended, see @ref onesdk_tracer_start_with_parent.
+*/
+ONESDK_DEFINE_INLINE_FUNCTION(onesdk_bool_t) onesdk_tracer_start_timed_with_parent(onesdk_tracer_handle_t tracer_handle, onesdk_tracer_handle_t parent_tracer_handle, onesdk_int64_t start_time) {
+    if (onesdk_ex_tracer_start_2(tracer_handle, parent_tracer_handle, start_time))
+        return 1;
+    onesdk_tracer_start(tracer_handle);
+    return 0;
+}
+
+/*========================================================================================================================================*/
+
 /** @brief Retrieves the string representation of the tag from an "outgoing taggable" tracer.
     @param tracer_handle                A valid tracer handle.
     @param[out] buffer                  [optional] Pointer to a buffer into which the string representation shall be copied.
@@ -213,6 +350,23 @@ ONESDK_DEFINE_INLINE_FUNCTION(void) onesdk_tracer_error(onesdk_tracer_handle_t t
 
     The string copied into @p buffer uses ASCII encoding.
 
+    Typical tags fit into a buffer of @ref ONESDK_DYNATRACE_STRING_TAG_BUFFER_SIZE bytes, so an application can try a fixed-size (e.g.
+    stack allocated) buffer first and only fetch the tag again if the required buffer size is bigger:
+
+    @code{.c}
+    char string_tag_buffer[ONESDK_DYNATRACE_STRING_TAG_BUFFER_SIZE];
+    char* string_tag = string_tag_buffer;
+    onesdk_size_t required_size = 0;
+    onesdk_size_t string_tag_size = onesdk_tracer_get_outgoing_dynatrace_string_tag(tracer, string_tag, sizeof(string_tag_buffer), &required_size);
+    if (required_size > sizeof(string_tag_buffer)) {
+        string_tag = (char*)malloc(required_size);
+        string_tag_size = string_tag != NULL ? onesdk_tracer_get_outgoing_dynatrace_string_tag(tracer, string_tag, required_size, NULL) : 0;
+    }
+    // ... send the tag along with the outgoing request ...
+    if (string_tag != string_tag_buffer)
+        free(string_tag);
+    @endcode
+
     @note If called with invalid arguments, the retrieved string will be an empty string.
     @note Calling this function multiple times for the same tracer is explicitly supported and will yield the same result.
     @note Retrieving both the string representation and the binary representation from the same tracer is explicitly supported.
@@ -237,6 +391,10 @@ ONESDK_DECLARE_FUNCTION(onesdk_size_t) onesdk_tracer_get_outgoing_dynatrace_stri
 
     If @p buffer is not `NULL` and @p buffer_size is big enough, this function will copy the binary representation into the provided buffer.
 
+    Typical tags fit into a buffer of @ref ONESDK_DYNATRACE_BYTE_TAG_BUFFER_SIZE bytes, so an application can try a fixed-size (e.g.
+    stack allocated) buffer first and only fetch the tag again if the required buffer size is bigger (see
+    @ref onesdk_tracer_get_outgoing_dynatrace_string_tag).
+
     @note If called with invalid arguments, the retrieved binary tag will be empty (have zero length).
     @note Calling this function multiple times for the same tracer is explicitly supported and will yield the same result.
     @note Retrieving both the string representation and the binary representation from the same tracer is explicitly supported.
@@ -351,6 +509,81 @@ ONESDK_DEFINE_INLINE_FUNCTION(void) onesdk_customrequestattribute_add_string(one
     onesdk_customrequestattribute_add_strings_p(&key, &value, 1);
 }
 
+/** @brief Describes one custom request attribute of any type, see @ref onesdk_customrequestattribute_add_batch. */
+typedef struct onesdk_customrequestattribute {
+    onesdk_string_t key;                    /**< @brief The key (name, ID) of the custom request attribute. */
+    onesdk_int32_t type;                    /**< @brief The type of the value, one of the `ONESDK_CUSTOM_REQUEST_ATTRIBUTE_TYPE_*` constants. */
+    onesdk_int64_t integer_value;           /**< @brief The value if the type is @ref ONESDK_CUSTOM_REQUEST_ATTRIBUTE_TYPE_INTEGER. */
+    double float_value;                     /**< @brief The value if the type is @ref ONESDK_CUSTOM_REQUEST_ATTRIBUTE_TYPE_FLOAT. */
+    onesdk_string_t string_value;           /**< @brief The value if the type is @ref ONESDK_CUSTOM_REQUEST_ATTRIBUTE_TYPE_STRING. */
+} onesdk_customrequestattribute_t;
+
+/** @internal Adds @p count attributes of type @p type from the value array that matches the type. */
+ONESDK_DEFINE_INLINE_FUNCTION(void) onesdk_customrequestattribute_add_typed_p(onesdk_int32_t type, onesdk_string_t const* keys, onesdk_int64_t const* integer_values, double const* float_values, onesdk_string_t const* string_values, onesdk_size_t count) {
+    if (type == ONESDK_CUSTOM_REQUEST_ATTRIBUTE_TYPE_INTEGER)
+        onesdk_customrequestattribute_add_integers_p(keys, integer_values, count);
+    else if (type == ONESDK_CUSTOM_REQUEST_ATTRIBUTE_TYPE_FLOAT)
+        onesdk_customrequestattribute_add_floats_p(keys, float_values, count);
+    else
+        onesdk_customrequestattribute_add_strings_p(keys, string_values, count);
+}
+
+/** @brief Adds custom request attributes of mixed types to the active tracer.
+    @param attributes   Pointer to an array of @p count custom request attributes.
+    @param count        The number of entries in @p attributes.
+
+    This function is equivalent to calling @ref onesdk_customrequestattribute_add_integer, @ref onesdk_customrequestattribute_add_float
+    or @ref onesdk_customrequestattribute_add_string for each entry of @p attributes, in the order of @p attributes. Consecutive entries
+    of the same type are passed to the agent in one call (up to 16 per call), so an application that collects its attributes into an
+    array (e.g. while processing a request) and groups them by type needs at most one call per type for each 16 attributes. Entries with
+    an unknown type are ignored.
+
+    The agent takes keys and values as separate arrays per type, so the entries are copied into arrays on the stack first. The limit of
+    16 entries per call keeps these arrays small (512 bytes), larger batches are split into several calls.
+
+    @note Just like the other custom request attribute functions, this function adds the attributes to the active tracer of the calling
+          thread. The agent interface has no function that adds them to a specific tracer. To add them to a request that is processed on
+          another thread, link the calling thread to that request first (see @ref in_process_links, or
+          `onesdk::request_context::add_custom_request_attributes` in C++).
+*/
+ONESDK_DEFINE_INLINE_FUNCTION(void) onesdk_customrequestattribute_add_batch(onesdk_customrequestattribute_t const* attributes, onesdk_size_t count) {
+    onesdk_string_t keys[16];
+    union {
+        onesdk_int64_t integers[16];
+        double floats[16];
+        onesdk_string_t strings[16];
+    } values;
+    onesdk_int32_t run_type = 0;
+    onesdk_size_t n = 0;
+    onesdk_size_t i;
+
+    if (attributes == NULL)
+        return;
+
+    /* Collect runs of consecutive attributes of the same type, so that the order of the attributes is kept. */
+    for (i = 0; i < count; i++) {
+        onesdk_int32_t const type = attributes[i].type;
+        if (type != ONESDK_CUSTOM_REQUEST_ATTRIBUTE_TYPE_INTEGER && type != ONESDK_CUSTOM_REQUEST_ATTRIBUTE_TYPE_FLOAT &&
+            type != ONESDK_CUSTOM_REQUEST_ATTRIBUTE_TYPE_STRING)
+            continue;
+        if (n != 0 && (type != run_type || n == 16)) {
+            onesdk_customrequestattribute_add_typed_p(run_type, keys, values.integers, values.floats, values.strings, n);
+            n = 0;
+        }
+        run_type = type;
+        keys[n] = attributes[i].key;
+        if (type == ONESDK_CUSTOM_REQUEST_ATTRIBUTE_TYPE_INTEGER)
+            values.integers[n] = attributes[i].integer_value;
+        else if (type == ONESDK_CUSTOM_REQUEST_ATTRIBUTE_TYPE_FLOAT)
+            values.floats[n] = attributes[i].float_value;
+        else
+            values.strings[n] = attributes[i].string_value;
+        n++;
+    }
+    if (n != 0)
+        onesdk_customrequestattribute_add_typed_p(run_type, keys, values.integers, values.floats, values.strings, n);
+}
+
 /*========================================================================================================================================*/
 
 /** @} */
@@ -631,6 +864,66 @@ ONESDK_DECLARE_FUNCTION(void) onesdk_databaserequesttracer_set_returned_row_coun
 */
 ONESDK_DECLARE_FUNCTION(void) onesdk_databaserequesttracer_set_round_trip_count(onesdk_tracer_handle_t tracer_handle, onesdk_int32_t round_trip_count);
 
+/** @brief Describes a completed database request, see @ref onesdk_databaserequesttracer_submit_batch. */
+typedef struct onesdk_databaserequest {
+    onesdk_string_t statement;              /**< @brief The database statement (SQL). */
+    onesdk_int64_t start_time;              /**< @brief Start time in microseconds since the Unix epoch (1970-01-01T00:00:00Z). */
+    onesdk_int64_t end_time;                /**< @brief End time in microseconds since the Unix epoch (1970-01-01T00:00:00Z). */
+    onesdk_int32_t returned_row_count;      /**< @brief The number of returned rows, or a negative value if unknown. */
+    onesdk_int32_t round_trip_count;        /**< @brief The number of round trips, or a negative value if unknown. */
+    onesdk_string_t error_class;            /**< @brief [optional] Error class, see @ref onesdk_tracer_error. */
+    onesdk_string_t error_message;          /**< @brief [optional] Error message, see @ref onesdk_tracer_error. */
+} onesdk_databaserequest_t;
+
+/** @brief Traces a batch of completed database requests.
+    @param databaseinfo_handle      A valid database info handle.
+    @param requests                 Pointer to an array of @p count completed database requests.
+    @param count                    The number of entries in @p requests.
+
+    This function is equivalent to creating, starting and ending one database request tracer per entry of @p requests (as by
+    @ref onesdk_databaserequesttracer_create_sql, @ref onesdk_tracer_start, @ref onesdk_databaserequesttracer_set_returned_row_count,
+    @ref onesdk_databaserequesttracer_set_round_trip_count, @ref onesdk_tracer_error and @ref onesdk_tracer_end), using the start and end
+    times of the entry instead of the current time. It's intended for applications that issue many small statements in a row (e.g. bulk
+    loaders), which can record the requests into an array and submit them all at once afterwards.
+
+    The agent state is checked once per batch: If the agent is not active, this function returns without doing anything else.
+
+    An error is only reported for entries where either @ref onesdk_databaserequest_t.error_class or
+    @ref onesdk_databaserequest_t.error_message is not a "null string". Thus a zero-initialized entry describes a request without error.
+
+    @note The start and end times are only used if the extended tracer functions have been enabled by calling
+          @ref onesdk_ex_api_enable_tracer_ext. Otherwise the requests are traced with the time at which this function is called.
+    @note Just like individually created tracers, the traced requests will be children of the active tracer of the calling thread.
+
+    @see @ref onesdk_databaseinfo_create
+*/
+ONESDK_DEFINE_INLINE_FUNCTION(void) onesdk_databaserequesttracer_submit_batch(onesdk_databaseinfo_handle_t databaseinfo_handle, onesdk_databaserequest_t const* requests, onesdk_size_t count) {
+    onesdk_size_t i;
+
+    if (databaseinfo_handle == ONESDK_INVALID_HANDLE || requests == NULL || count == 0)
+        return;
+    if (onesdk_agent_get_current_state() != ONESDK_AGENT_STATE_ACTIVE)
+        return;
+
+    for (i = 0; i < count; i++) {
+        onesdk_databaserequest_t const* const request = &requests[i];
+        onesdk_tracer_handle_t const tracer = onesdk_databaserequesttracer_create_sql_p(databaseinfo_handle, &request->statement);
+        onesdk_bool_t const timed = onesdk_tracer_start_timed(tracer, request->start_time);
+
+        if (request->returned_row_count >= 0)
+            onesdk_databaserequesttracer_set_returned_row_count(tracer, request->returned_row_count);
+        if (request->round_trip_count >= 0)
+            onesdk_databaserequesttracer_set_round_trip_count(tracer, request->round_trip_count);
+        if (request->error_class.ccsid != ONESDK_CCSID_NULL || request->error_message.ccsid != ONESDK_CCSID_NULL)
+            onesdk_tracer_error_p(tracer, &request->error_class, &request->error_message);
+
+        if (timed)
+            onesdk_tracer_end_timed(tracer, request->end_time);
+        else
+            onesdk_tracer_end(tracer);
+    }
+}
+
 /*========================================================================================================================================*/
 
 /** @} */
@@ -366,6 +366,54 @@ typedef onesdk_handle_t onesdk_messagingsysteminfo_handle_t; /**< @brief A handl
 */
 #define ONESDK_DYNATRACE_HTTP_HEADER_NAME       "X-dynaTrace"
 
+/** @ingroup tracers
+    @{
+*/
+
+/** @brief Recommended size of a first-try buffer for the string representation of an outgoing tag (including null terminator).
+
+    Typical tags fit into a buffer of this size, so an application that passes a (e.g. stack allocated) buffer of this size to
+    @ref onesdk_tracer_get_outgoing_dynatrace_string_tag usually gets the tag with a single call and without heap allocation. The maximum
+    tag size is determined by the agent though, this is not a guarantee: applications must check the required buffer size and fetch the
+    tag again into a bigger buffer if it exceeds this size.
+*/
+#define ONESDK_DYNATRACE_STRING_TAG_BUFFER_SIZE 512
+
+/** @brief Recommended size of a first-try buffer for the binary representation of an outgoing tag.
+
+    Like @ref ONESDK_DYNATRACE_STRING_TAG_BUFFER_SIZE for @ref onesdk_tracer_get_outgoing_dynatrace_byte_tag, this is not a guarantee.
+*/
+#define ONESDK_DYNATRACE_BYTE_TAG_BUFFER_SIZE 512
+
+/** @} */
+
+/** @ingroup in_process_links
+    @brief Recommended size of a first-try buffer for an in-process link.
+
+    Typical in-process links fit into a buffer of this size, so an application that passes a (e.g. stack allocated or fixed-size member)
+    buffer of this size to @ref onesdk_inprocesslink_create usually gets the link with a single call and without heap allocation. The
+    maximum link size is determined by the agent though, this is not a guarantee: applications must check the required buffer size and
+    fetch the link again into a bigger buffer if it exceeds this size.
+*/
+#define ONESDK_IN_PROCESS_LINK_BUFFER_SIZE 512
+
+/*========================================================================================================================================*/
+
+/** @ingroup custom_request_attributes
+    @{
+*/
+
+/** @brief The custom request attribute has an integer value, see @ref onesdk_customrequestattribute_t. */
+#define ONESDK_CUSTOM_REQUEST_ATTRIBUTE_TYPE_INTEGER    1
+
+/** @brief The custom request attribute has a floating point value, see @ref onesdk_customrequestattribute_t. */
+#define ONESDK_CUSTOM_REQUEST_ATTRIBUTE_TYPE_FLOAT      2
+
+/** @brief The custom request attribute has a string value, see @ref onesdk_customrequestattribute_t. */
+#define ONESDK_CUSTOM_REQUEST_ATTRIBUTE_TYPE_STRING     3
+
+/** @} */
+
 /*========================================================================================================================================*/
 
 /** @ingroup init
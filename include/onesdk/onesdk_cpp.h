@@ -0,0 +1,933 @@
+/*
+    Copyright 2017-2019 Dynatrace LLC
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef ONESDK_CPP_H_INCLUDED
+#define ONESDK_CPP_H_INCLUDED
+
+/** @file
+    @brief Defines header-only C++11 RAII wrappers for tracers, see @ref cpp_tracers.
+*/
+
+/*========================================================================================================================================*/
+
+#if !defined(__cplusplus)
+#    error onesdk_cpp.h can only be used from C++ (C++11 or later).
+#endif
+
+#include "onesdk/onesdk_agent.h"
+#include "onesdk/onesdk_cpp_string.h"
+#include "onesdk/onesdk_string.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <new>
+#include <utility>
+
+/*========================================================================================================================================*/
+
+/** @defgroup cpp_tracers C++ Tracer Guards
+    @brief Movable RAII guards that create, start and end tracers.
+
+    The classes in this module are thin wrappers around the C tracer functions. They hold nothing but the tracer handle (and whether it
+    was started with a caller-supplied start time) and all member functions are `inline` and `noexcept`, so a compiler with optimizations
+    enabled will generate the same calls into the SDK as hand-written code that uses the C functions directly. Member functions of an
+    empty guard don't call into the SDK at all.
+
+    Guards don't create a tracer while the cached agent state says that the agent is not active (see @ref onesdk::agent_active), so with
+    an inactive agent a guard costs one well-predicted branch per call site.
+
+    @warning The cached agent state only changes when @ref onesdk::refresh_agent_state is called, not when the agent state changes. After
+             a refresh that saw an inactive agent, guards create no tracers (even if the agent has become active again in the meantime)
+             until the next refresh. An application that refreshes the cache once must keep refreshing it, e.g. with an
+             @ref onesdk::agent_state_refresher, or requests may go untraced for as long as the application runs.
+
+    The guard ends its tracer when it goes out of scope (or when it is moved-to), so an application needs to set error information only
+    and doesn't have to repeat @ref onesdk_tracer_end on every exit path:
+
+    @code{.cpp}
+    onesdk::custom_service_tracer tracer(onesdk_asciistr("perform_cleanup"), onesdk_asciistr("CleanupService"));
+    tracer.start();
+    try {
+        do_cleanup();
+    } catch (...) {
+        tracer.error_from_current_exception();
+        throw;
+    }
+    // tracer is ended here, also if do_cleanup() threw
+    @endcode
+
+    Moving a guard transfers ownership of the tracer handle, the moved-from guard is left empty. Note that moving a guard to another
+    thread does not lift the thread affinity of the tracer (see @ref tracers).
+
+    @{
+*/
+
+namespace onesdk {
+
+/*========================================================================================================================================*/
+
+/** @brief Converts a `std::chrono::steady_clock` time point to the timestamp format of @ref onesdk_tracer_start_timed.
+    @return Microseconds since the Unix epoch.
+
+    Taking a `steady_clock` timestamp is cheap and doesn't call into the SDK, so applications can record the begin and end of an operation
+    on a latency-critical thread and convert and submit them later. The offset between `steady_clock` and `system_clock` is measured once
+    per process, on first use.
+*/
+inline onesdk_int64_t to_timestamp(std::chrono::steady_clock::time_point time_point) noexcept {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    static microseconds const steady_to_system_offset =
+        duration_cast<microseconds>(std::chrono::system_clock::now().time_since_epoch()) -
+        duration_cast<microseconds>(std::chrono::steady_clock::now().time_since_epoch());
+    return static_cast<onesdk_int64_t>((duration_cast<microseconds>(time_point.time_since_epoch()) + steady_to_system_offset).count());
+}
+
+/*========================================================================================================================================*/
+
+/** @name Cached Agent State
+    @brief A per-module copy of the agent state that can be checked without calling into the SDK.
+
+    Every SDK call made while the agent is not active goes through the stub into a no-op. Code on hot paths can avoid these calls (and
+    building their arguments) by checking @ref agent_active first, which reads a cache-line-aligned flag:
+
+    @code{.cpp}
+    onesdk_initialize();
+    onesdk::refresh_agent_state(); // and then periodically, e.g. with an onesdk::agent_state_refresher
+
+    if (onesdk::agent_active())
+        add_all_request_headers(tracer, request);
+    @endcode
+
+    The cache is only updated by @ref refresh_agent_state. Until it has been called for the first time, @ref agent_active returns `true`,
+    so code that never refreshes the cache behaves exactly as without it. The tracer guards use the cache to skip creating tracers.
+
+    @note The cache is a function-local `static` in an inline function, so each executable and each shared library (DLL) that includes this
+          header gets its own copy. @ref refresh_agent_state only updates the copy of the module that calls it; every module that relies
+          on the cache has to refresh it.
+
+    @note The guard constructors take @ref onesdk_string_t arguments, which the caller has already built (including any `strlen` or
+          conversion) when the constructor checks the cache. Only the calls into the SDK are skipped. To also skip building expensive
+          arguments, check @ref agent_active before building them, as in the example above.
+    @{
+*/
+
+/** @internal */
+namespace detail {
+
+/** @internal */
+struct alignas(64) agent_state_cache {
+    std::atomic<bool> inactive;
+    std::atomic<onesdk_int32_t> state;
+};
+
+/** @internal */
+inline agent_state_cache& agent_state_storage() noexcept {
+    // Constant-initialized, so there's no guard variable to check on each access.
+    static agent_state_cache cache = { { false }, { ONESDK_AGENT_STATE_ACTIVE } };
+    return cache;
+}
+
+} // namespace detail
+
+/** @brief Queries the agent state with @ref onesdk_agent_get_current_state and stores it in the cache.
+    @return The current agent state.
+
+    Call this after @ref onesdk_initialize and whenever the state may have changed (the agent can become temporarily inactive and active
+    again at any time, so applications that use the cache should refresh it periodically, e.g. once per second).
+*/
+inline onesdk_int32_t refresh_agent_state() noexcept {
+    onesdk_int32_t const state = onesdk_agent_get_current_state();
+    detail::agent_state_cache& cache = detail::agent_state_storage();
+    cache.state.store(state, std::memory_order_relaxed);
+    cache.inactive.store(state != ONESDK_AGENT_STATE_ACTIVE, std::memory_order_relaxed);
+    return state;
+}
+
+/** @brief Returns `false` if the agent state was not @ref ONESDK_AGENT_STATE_ACTIVE at the last @ref refresh_agent_state. */
+inline bool agent_active() noexcept {
+    return !detail::agent_state_storage().inactive.load(std::memory_order_relaxed);
+}
+
+/** @brief Returns the agent state stored by the last @ref refresh_agent_state (@ref ONESDK_AGENT_STATE_ACTIVE if it was never called). */
+inline onesdk_int32_t cached_agent_state() noexcept {
+    return detail::agent_state_storage().state.load(std::memory_order_relaxed);
+}
+
+/** @} */
+
+/*========================================================================================================================================*/
+
+/** @brief Owns a tracer handle and ends the tracer on destruction.
+
+    This is the common base class of all tracer guards. It can also be used directly to take ownership of a tracer handle that was
+    created with one of the `onesdk_*tracer_create` functions.
+
+    @note The constructors of the derived guards that create a tracer leave the guard empty if @ref agent_active returns `false`, i.e.
+          if the agent was not active at the last @ref refresh_agent_state. They don't query the current agent state.
+*/
+class tracer {
+public:
+    /** @brief Constructs an empty guard. */
+    tracer() noexcept : m_handle(ONESDK_INVALID_HANDLE), m_timed(false) {}
+
+    /** @brief Takes ownership of @p tracer_handle. */
+    explicit tracer(onesdk_tracer_handle_t tracer_handle) noexcept : m_handle(tracer_handle), m_timed(false) {}
+
+    tracer(tracer const&) = delete; // We're non-copyable.
+    tracer& operator =(tracer const&) = delete; // We're non-copyable.
+
+    tracer(tracer&& other) noexcept : m_handle(ONESDK_INVALID_HANDLE), m_timed(other.m_timed) {
+        m_handle = other.release();
+    }
+
+    tracer& operator =(tracer&& other) noexcept {
+        if (this != &other) {
+            end();
+            m_timed = other.m_timed;
+            m_handle = other.release();
+        }
+        return *this;
+    }
+
+    ~tracer() {
+        end();
+    }
+
+    /** @brief Returns the owned tracer handle (may be @ref ONESDK_INVALID_HANDLE). */
+    onesdk_tracer_handle_t handle() const noexcept { return m_handle; }
+
+    /** @brief Returns `true` if the guard owns a valid tracer handle. */
+    explicit operator bool() const noexcept { return m_handle != ONESDK_INVALID_HANDLE; }
+
+    /** @brief See @ref onesdk_tracer_start. */
+    void start() noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_tracer_start(m_handle);
+    }
+
+    /** @brief Starts the tracer with a caller-supplied start time, see @ref onesdk_tracer_start_timed. */
+    void start(std::chrono::steady_clock::time_point start_time) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            m_timed = onesdk_tracer_start_timed(m_handle, to_timestamp(start_time)) != 0;
+    }
+
+    /** @brief Starts the tracer as a child of @p parent, see @ref onesdk_tracer_start_with_parent.
+
+        If @p parent is empty, the tracer is linked to the active tracer of the calling thread. @p parent must not be ended before this
+        tracer, so it can't be kept open across event-loop callbacks; use a @ref request_context there.
+    */
+    void start_with_parent(tracer const& parent) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_tracer_start_with_parent(m_handle, parent.m_handle);
+    }
+
+    /** @brief Starts the tracer as a child of @p parent with a caller-supplied start time, see @ref onesdk_tracer_start_timed_with_parent. */
+    void start_with_parent(tracer const& parent, std::chrono::steady_clock::time_point start_time) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            m_timed = onesdk_tracer_start_timed_with_parent(m_handle, parent.m_handle, to_timestamp(start_time)) != 0;
+    }
+
+    /** @brief See @ref onesdk_tracer_error. */
+    void error(onesdk_string_t error_class, onesdk_string_t error_message) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_tracer_error(m_handle, error_class, error_message);
+    }
+
+    /** @brief Sets error information from a `std::exception`, using `"std::exception"` as error class and `e.what()` as message. */
+    void error(std::exception const& e) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_tracer_error(m_handle, asciistr("std::exception"), onesdk_asciistr(e.what()));
+    }
+
+    /** @brief Sets error information from the exception that is currently being handled.
+
+        Must only be called from within a `catch` block. Exceptions derived from `std::exception` are reported as by
+        @ref error(std::exception const&), any other exception as `"unknown exception"`.
+    */
+    void error_from_current_exception() noexcept {
+        try {
+            throw;
+        } catch (std::exception const& e) {
+            error(e);
+        } catch (...) {
+            error(asciistr("unknown exception"), asciistr("unknown error"));
+        }
+    }
+
+    /** @brief Ends the tracer now (see @ref onesdk_tracer_end). Calling this function on an empty guard does nothing. */
+    void end() noexcept {
+        if (m_timed)
+            end(std::chrono::steady_clock::now());
+        else if (m_handle != ONESDK_INVALID_HANDLE) {
+            onesdk_tracer_end(m_handle);
+            m_handle = ONESDK_INVALID_HANDLE;
+        }
+    }
+
+    /** @brief Ends the tracer with a caller-supplied end time (see @ref onesdk_tracer_end_timed).
+
+        If the tracer was not started by @ref start(std::chrono::steady_clock::time_point) or the start time could not be applied, the
+        tracer is ended with the current time instead. Calling this function on an empty guard does nothing.
+    */
+    void end(std::chrono::steady_clock::time_point end_time) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE) {
+            if (m_timed)
+                onesdk_tracer_end_timed(m_handle, to_timestamp(end_time));
+            else
+                onesdk_tracer_end(m_handle);
+            m_handle = ONESDK_INVALID_HANDLE;
+        }
+        m_timed = false;
+    }
+
+    /** @brief Releases ownership of the tracer handle without ending the tracer and returns it. */
+    onesdk_tracer_handle_t release() noexcept {
+        onesdk_tracer_handle_t const tracer_handle = m_handle;
+        m_handle = ONESDK_INVALID_HANDLE;
+        m_timed = false;
+        return tracer_handle;
+    }
+
+protected:
+    onesdk_tracer_handle_t m_handle;
+    bool m_timed;
+};
+
+/*========================================================================================================================================*/
+
+/** @brief Passes HTTP headers or parameters to a web request tracer in batches, without building arrays of all of them first.
+
+    A @ref name_value_sink is handed to the producer function that is passed to e.g.
+    @ref incoming_web_request_tracer::add_request_headers_from. It collects up to @ref batch_size pairs in a fixed-size array (no heap
+    allocation) and passes each full batch to the SDK with a single call. The remaining pairs are passed when the producer returns.
+
+    The strings passed to @ref add must stay valid until the batch is passed to the SDK, i.e. until the producer returns.
+*/
+class name_value_sink {
+public:
+    /** @brief The maximum number of pairs that are passed to the SDK with one call. */
+    static std::size_t const batch_size = 16;
+
+    /** @brief The SDK function that receives the batches (e.g. @ref onesdk_incomingwebrequesttracer_add_request_headers_p). */
+    typedef void ONESDK_CALL add_function_t(onesdk_tracer_handle_t tracer_handle, onesdk_string_t const* names,
+        onesdk_string_t const* values, onesdk_size_t count);
+
+    /** @brief Constructs a sink that passes batches to @p add_function for @p tracer_handle. */
+    name_value_sink(add_function_t* add_function, onesdk_tracer_handle_t tracer_handle) noexcept
+        : m_add_function(add_function), m_handle(tracer_handle), m_count(0) {}
+
+    name_value_sink(name_value_sink const&) = delete; // We're non-copyable.
+    name_value_sink& operator =(name_value_sink const&) = delete; // We're non-copyable.
+
+    /** @brief Passes the remaining pairs to the SDK. */
+    ~name_value_sink() {
+        flush();
+    }
+
+    /** @brief Adds a pair. */
+    void add(onesdk_string_t name, onesdk_string_t value) noexcept {
+        m_names[m_count] = name;
+        m_values[m_count] = value;
+        if (++m_count == batch_size)
+            flush();
+    }
+
+    /** @brief Passes the collected pairs to the SDK now. */
+    void flush() noexcept {
+        if (m_count != 0)
+            m_add_function(m_handle, m_names, m_values, static_cast<onesdk_size_t>(m_count));
+        m_count = 0;
+    }
+
+private:
+    add_function_t* const m_add_function;
+    onesdk_tracer_handle_t const m_handle;
+    std::size_t m_count;
+    onesdk_string_t m_names[batch_size];
+    onesdk_string_t m_values[batch_size];
+};
+
+/** @internal */
+namespace detail {
+
+/** @internal */
+template <typename Producer>
+void produce_name_value_pairs(name_value_sink::add_function_t* add_function, onesdk_tracer_handle_t tracer_handle, Producer&& producer) {
+    if (tracer_handle == ONESDK_INVALID_HANDLE)
+        return;
+    name_value_sink sink(add_function, tracer_handle);
+    std::forward<Producer>(producer)(sink);
+}
+
+} // namespace detail
+
+/*========================================================================================================================================*/
+
+/** @brief Base class for guards of "outgoing taggable" tracers. */
+class outgoing_taggable_tracer : public tracer {
+public:
+    /** @brief See @ref onesdk_tracer_get_outgoing_dynatrace_string_tag.
+
+        For an empty guard, @p buffer receives an empty string and @p *required_buffer_size is set to zero.
+    */
+    onesdk_size_t get_outgoing_dynatrace_string_tag(char* buffer, onesdk_size_t buffer_size, onesdk_size_t* required_buffer_size) const noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            return onesdk_tracer_get_outgoing_dynatrace_string_tag(m_handle, buffer, buffer_size, required_buffer_size);
+        if (buffer != nullptr && buffer_size != 0)
+            buffer[0] = '\0';
+        return empty_tag(required_buffer_size);
+    }
+
+    /** @brief See @ref onesdk_tracer_get_outgoing_dynatrace_byte_tag.
+
+        For an empty guard, nothing is copied and @p *required_buffer_size is set to zero.
+    */
+    onesdk_size_t get_outgoing_dynatrace_byte_tag(unsigned char* buffer, onesdk_size_t buffer_size, onesdk_size_t* required_buffer_size) const noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            return onesdk_tracer_get_outgoing_dynatrace_byte_tag(m_handle, buffer, buffer_size, required_buffer_size);
+        return empty_tag(required_buffer_size);
+    }
+
+    /** @brief Retrieves the string representation of the outgoing tag into a fixed-size array.
+        @return The number of characters copied into @p buffer, not including the terminating null character.
+
+        No array size is guaranteed to be big enough (see @ref ONESDK_DYNATRACE_STRING_TAG_BUFFER_SIZE). If the tag doesn't fit, @p buffer
+        receives an empty string and @p *required_buffer_size (if given) tells the size of the buffer that is needed to fetch it again.
+    */
+    template <onesdk_size_t N>
+    onesdk_size_t get_outgoing_dynatrace_string_tag(char (&buffer)[N], onesdk_size_t* required_buffer_size = nullptr) const noexcept {
+        return get_outgoing_dynatrace_string_tag(buffer, N, required_buffer_size);
+    }
+
+    /** @brief Retrieves the binary representation of the outgoing tag into a fixed-size array.
+        @return The number of bytes copied into @p buffer.
+
+        Like @ref get_outgoing_dynatrace_string_tag(char (&)[N], onesdk_size_t*), nothing is copied if the tag doesn't fit.
+    */
+    template <onesdk_size_t N>
+    onesdk_size_t get_outgoing_dynatrace_byte_tag(unsigned char (&buffer)[N], onesdk_size_t* required_buffer_size = nullptr) const noexcept {
+        return get_outgoing_dynatrace_byte_tag(buffer, N, required_buffer_size);
+    }
+
+protected:
+    outgoing_taggable_tracer() noexcept {}
+    explicit outgoing_taggable_tracer(onesdk_tracer_handle_t tracer_handle) noexcept : tracer(tracer_handle) {}
+
+private:
+    static onesdk_size_t empty_tag(onesdk_size_t* required_buffer_size) noexcept {
+        if (required_buffer_size != nullptr)
+            *required_buffer_size = 0;
+        return 0;
+    }
+};
+
+/** @brief Base class for guards of "incoming taggable" tracers. */
+class incoming_taggable_tracer : public tracer {
+public:
+    /** @brief See @ref onesdk_tracer_set_incoming_dynatrace_string_tag. */
+    void set_incoming_dynatrace_string_tag(onesdk_string_t string_tag) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_tracer_set_incoming_dynatrace_string_tag(m_handle, string_tag);
+    }
+
+    /** @brief See @ref onesdk_tracer_set_incoming_dynatrace_byte_tag. */
+    void set_incoming_dynatrace_byte_tag(unsigned char const* byte_tag, onesdk_size_t byte_tag_size) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_tracer_set_incoming_dynatrace_byte_tag(m_handle, byte_tag, byte_tag_size);
+    }
+
+protected:
+    incoming_taggable_tracer() noexcept {}
+    explicit incoming_taggable_tracer(onesdk_tracer_handle_t tracer_handle) noexcept : tracer(tracer_handle) {}
+};
+
+/*========================================================================================================================================*/
+
+/** @brief Guard for an outgoing remote call tracer, see @ref onesdk_outgoingremotecalltracer_create. */
+class outgoing_remote_call_tracer : public outgoing_taggable_tracer {
+public:
+    outgoing_remote_call_tracer() noexcept {}
+
+    outgoing_remote_call_tracer(onesdk_string_t service_method, onesdk_string_t service_name, onesdk_string_t service_endpoint,
+        onesdk_int32_t channel_type, onesdk_string_t channel_endpoint) noexcept
+        : outgoing_taggable_tracer(agent_active()
+            ? onesdk_outgoingremotecalltracer_create(service_method, service_name, service_endpoint, channel_type, channel_endpoint)
+            : ONESDK_INVALID_HANDLE) {}
+
+    /** @brief See @ref onesdk_outgoingremotecalltracer_set_protocol_name. */
+    void set_protocol_name(onesdk_string_t protocol_name) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_outgoingremotecalltracer_set_protocol_name(m_handle, protocol_name);
+    }
+};
+
+/** @brief Guard for an incoming remote call tracer, see @ref onesdk_incomingremotecalltracer_create. */
+class incoming_remote_call_tracer : public incoming_taggable_tracer {
+public:
+    incoming_remote_call_tracer() noexcept {}
+
+    incoming_remote_call_tracer(onesdk_string_t service_method, onesdk_string_t service_name, onesdk_string_t service_endpoint) noexcept
+        : incoming_taggable_tracer(agent_active()
+            ? onesdk_incomingremotecalltracer_create(service_method, service_name, service_endpoint)
+            : ONESDK_INVALID_HANDLE) {}
+
+    /** @brief See @ref onesdk_incomingremotecalltracer_set_protocol_name. */
+    void set_protocol_name(onesdk_string_t protocol_name) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_incomingremotecalltracer_set_protocol_name(m_handle, protocol_name);
+    }
+};
+
+/** @brief Guard for a database request tracer, see @ref onesdk_databaserequesttracer_create_sql. */
+class database_request_tracer : public tracer {
+public:
+    database_request_tracer() noexcept {}
+
+    /** @brief Takes ownership of @p tracer_handle, which must refer to a database request tracer. */
+    explicit database_request_tracer(onesdk_tracer_handle_t tracer_handle) noexcept : tracer(tracer_handle) {}
+
+    database_request_tracer(onesdk_databaseinfo_handle_t databaseinfo_handle, onesdk_string_t statement) noexcept
+        : tracer(agent_active() ? onesdk_databaserequesttracer_create_sql(databaseinfo_handle, statement) : ONESDK_INVALID_HANDLE) {}
+
+    /** @brief See @ref onesdk_databaserequesttracer_set_returned_row_count. */
+    void set_returned_row_count(onesdk_int32_t returned_row_count) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_databaserequesttracer_set_returned_row_count(m_handle, returned_row_count);
+    }
+
+    /** @brief See @ref onesdk_databaserequesttracer_set_round_trip_count. */
+    void set_round_trip_count(onesdk_int32_t round_trip_count) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_databaserequesttracer_set_round_trip_count(m_handle, round_trip_count);
+    }
+};
+
+/** @brief Guard for an incoming web request tracer, see @ref onesdk_incomingwebrequesttracer_create. */
+class incoming_web_request_tracer : public incoming_taggable_tracer {
+public:
+    incoming_web_request_tracer() noexcept {}
+
+    incoming_web_request_tracer(onesdk_webapplicationinfo_handle_t webapplicationinfo_handle, onesdk_string_t url, onesdk_string_t method) noexcept
+        : incoming_taggable_tracer(agent_active()
+            ? onesdk_incomingwebrequesttracer_create(webapplicationinfo_handle, url, method)
+            : ONESDK_INVALID_HANDLE) {}
+
+    /** @brief See @ref onesdk_incomingwebrequesttracer_set_remote_address. */
+    void set_remote_address(onesdk_string_t remote_address) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_incomingwebrequesttracer_set_remote_address(m_handle, remote_address);
+    }
+
+    /** @brief See @ref onesdk_incomingwebrequesttracer_add_request_header. */
+    void add_request_header(onesdk_string_t name, onesdk_string_t value) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_incomingwebrequesttracer_add_request_header(m_handle, name, value);
+    }
+
+    /** @brief Adds @p count HTTP request headers at once, see @ref onesdk_incomingwebrequesttracer_add_request_header. */
+    void add_request_headers(onesdk_string_t const* names, onesdk_string_t const* values, onesdk_size_t count) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_incomingwebrequesttracer_add_request_headers_p(m_handle, names, values, count);
+    }
+
+    /** @brief Adds HTTP request headers by calling `producer(sink)` with a @ref name_value_sink, see
+               @ref onesdk_incomingwebrequesttracer_add_request_header.
+
+        @p producer is not called if the guard is empty, so an application that iterates its own header list in @p producer doesn't do any
+        work for requests that aren't traced:
+
+        @code{.cpp}
+        tracer.add_request_headers_from([&](onesdk::name_value_sink& sink) {
+            for (auto const& header : request.headers)
+                sink.add(onesdk::utf8str(header.first), onesdk::utf8str(header.second));
+        });
+        @endcode
+    */
+    template <typename Producer>
+    void add_request_headers_from(Producer&& producer) {
+        detail::produce_name_value_pairs(onesdk_incomingwebrequesttracer_add_request_headers_p, m_handle, std::forward<Producer>(producer));
+    }
+
+    /** @brief See @ref onesdk_incomingwebrequesttracer_add_parameter. */
+    void add_parameter(onesdk_string_t name, onesdk_string_t value) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_incomingwebrequesttracer_add_parameter(m_handle, name, value);
+    }
+
+    /** @brief Adds HTTP parameters by calling `producer(sink)` with a @ref name_value_sink, see @ref add_request_headers_from. */
+    template <typename Producer>
+    void add_parameters_from(Producer&& producer) {
+        detail::produce_name_value_pairs(onesdk_incomingwebrequesttracer_add_parameters_p, m_handle, std::forward<Producer>(producer));
+    }
+
+    /** @brief See @ref onesdk_incomingwebrequesttracer_add_response_header. */
+    void add_response_header(onesdk_string_t name, onesdk_string_t value) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_incomingwebrequesttracer_add_response_header(m_handle, name, value);
+    }
+
+    /** @brief Adds HTTP response headers by calling `producer(sink)` with a @ref name_value_sink, see @ref add_request_headers_from. */
+    template <typename Producer>
+    void add_response_headers_from(Producer&& producer) {
+        detail::produce_name_value_pairs(onesdk_incomingwebrequesttracer_add_response_headers_p, m_handle, std::forward<Producer>(producer));
+    }
+
+    /** @brief See @ref onesdk_incomingwebrequesttracer_set_status_code. */
+    void set_status_code(onesdk_int32_t status_code) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_incomingwebrequesttracer_set_status_code(m_handle, status_code);
+    }
+};
+
+/** @brief Guard for an outgoing web request tracer, see @ref onesdk_outgoingwebrequesttracer_create. */
+class outgoing_web_request_tracer : public outgoing_taggable_tracer {
+public:
+    outgoing_web_request_tracer() noexcept {}
+
+    outgoing_web_request_tracer(onesdk_string_t url, onesdk_string_t method) noexcept
+        : outgoing_taggable_tracer(agent_active() ? onesdk_outgoingwebrequesttracer_create(url, method) : ONESDK_INVALID_HANDLE) {}
+
+    /** @brief See @ref onesdk_outgoingwebrequesttracer_add_request_header. */
+    void add_request_header(onesdk_string_t name, onesdk_string_t value) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_outgoingwebrequesttracer_add_request_header(m_handle, name, value);
+    }
+
+    /** @brief Adds HTTP request headers by calling `producer(sink)` with a @ref name_value_sink, see
+               @ref incoming_web_request_tracer::add_request_headers_from.
+    */
+    template <typename Producer>
+    void add_request_headers_from(Producer&& producer) {
+        detail::produce_name_value_pairs(onesdk_outgoingwebrequesttracer_add_request_headers_p, m_handle, std::forward<Producer>(producer));
+    }
+
+    /** @brief See @ref onesdk_outgoingwebrequesttracer_add_response_header. */
+    void add_response_header(onesdk_string_t name, onesdk_string_t value) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_outgoingwebrequesttracer_add_response_header(m_handle, name, value);
+    }
+
+    /** @brief Adds HTTP response headers by calling `producer(sink)` with a @ref name_value_sink, see
+               @ref incoming_web_request_tracer::add_request_headers_from.
+    */
+    template <typename Producer>
+    void add_response_headers_from(Producer&& producer) {
+        detail::produce_name_value_pairs(onesdk_outgoingwebrequesttracer_add_response_headers_p, m_handle, std::forward<Producer>(producer));
+    }
+
+    /** @brief See @ref onesdk_outgoingwebrequesttracer_set_status_code. */
+    void set_status_code(onesdk_int32_t status_code) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_outgoingwebrequesttracer_set_status_code(m_handle, status_code);
+    }
+};
+
+/** @brief Guard for a custom service tracer, see @ref onesdk_customservicetracer_create. */
+class custom_service_tracer : public tracer {
+public:
+    custom_service_tracer() noexcept {}
+
+    custom_service_tracer(onesdk_string_t service_method, onesdk_string_t service_name) noexcept
+        : tracer(agent_active() ? onesdk_customservicetracer_create(service_method, service_name) : ONESDK_INVALID_HANDLE) {}
+};
+
+/** @brief Guard for an outgoing message tracer, see @ref onesdk_outgoingmessagetracer_create. */
+class outgoing_message_tracer : public outgoing_taggable_tracer {
+public:
+    outgoing_message_tracer() noexcept {}
+
+    explicit outgoing_message_tracer(onesdk_messagingsysteminfo_handle_t messagingsysteminfo_handle) noexcept
+        : outgoing_taggable_tracer(agent_active()
+            ? onesdk_outgoingmessagetracer_create(messagingsysteminfo_handle)
+            : ONESDK_INVALID_HANDLE) {}
+
+    /** @brief See @ref onesdk_outgoingmessagetracer_set_vendor_message_id. */
+    void set_vendor_message_id(onesdk_string_t vendor_message_id) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_outgoingmessagetracer_set_vendor_message_id(m_handle, vendor_message_id);
+    }
+
+    /** @brief See @ref onesdk_outgoingmessagetracer_set_correlation_id. */
+    void set_correlation_id(onesdk_string_t correlation_id) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_outgoingmessagetracer_set_correlation_id(m_handle, correlation_id);
+    }
+};
+
+/** @brief Guard for an incoming message receive tracer, see @ref onesdk_incomingmessagereceivetracer_create. */
+class incoming_message_receive_tracer : public tracer {
+public:
+    incoming_message_receive_tracer() noexcept {}
+
+    explicit incoming_message_receive_tracer(onesdk_messagingsysteminfo_handle_t messagingsysteminfo_handle) noexcept
+        : tracer(agent_active() ? onesdk_incomingmessagereceivetracer_create(messagingsysteminfo_handle) : ONESDK_INVALID_HANDLE) {}
+};
+
+/** @brief Guard for an incoming message process tracer, see @ref onesdk_incomingmessageprocesstracer_create. */
+class incoming_message_process_tracer : public incoming_taggable_tracer {
+public:
+    incoming_message_process_tracer() noexcept {}
+
+    explicit incoming_message_process_tracer(onesdk_messagingsysteminfo_handle_t messagingsysteminfo_handle) noexcept
+        : incoming_taggable_tracer(agent_active()
+            ? onesdk_incomingmessageprocesstracer_create(messagingsysteminfo_handle)
+            : ONESDK_INVALID_HANDLE) {}
+
+    /** @brief See @ref onesdk_incomingmessageprocesstracer_set_vendor_message_id. */
+    void set_vendor_message_id(onesdk_string_t vendor_message_id) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_incomingmessageprocesstracer_set_vendor_message_id(m_handle, vendor_message_id);
+    }
+
+    /** @brief See @ref onesdk_incomingmessageprocesstracer_set_correlation_id. */
+    void set_correlation_id(onesdk_string_t correlation_id) noexcept {
+        if (m_handle != ONESDK_INVALID_HANDLE)
+            onesdk_incomingmessageprocesstracer_set_correlation_id(m_handle, correlation_id);
+    }
+};
+
+/** @brief An in-process link that can be captured by value, see @ref in_process_links.
+
+    @ref current retrieves the link to the innermost active tracer of the calling thread. Links of up to
+    @ref ONESDK_IN_PROCESS_LINK_BUFFER_SIZE bytes (the usual case) are fetched with a single call and stored in the object itself (copying
+    it copies only the bytes in use), so it can be captured by value by a task that is handed to another thread, without allocating
+    memory. Bigger links are fetched again into a heap buffer, which copies of the object share:
+
+    @code{.cpp}
+    onesdk::in_process_link const link = onesdk::in_process_link::current();
+    thread_pool.submit([link] {
+        onesdk::in_process_link_tracer tracer(link);
+        tracer.start();
+        // ... tracers started here are linked to the tracer that was active when the link was created ...
+    });
+    @endcode
+*/
+class in_process_link {
+public:
+    /** @brief Constructs an empty link. */
+    in_process_link() noexcept : m_size(0) {}
+
+    in_process_link(in_process_link const& other) noexcept : m_size(other.m_size), m_large_data(other.m_large_data) {
+        if (!m_large_data)
+            std::memcpy(m_data, other.m_data, static_cast<std::size_t>(m_size));
+    }
+
+    in_process_link& operator =(in_process_link const& other) noexcept {
+        if (this != &other) {
+            m_size = other.m_size;
+            m_large_data = other.m_large_data;
+            if (!m_large_data)
+                std::memcpy(m_data, other.m_data, static_cast<std::size_t>(m_size));
+        }
+        return *this;
+    }
+
+    /** @brief Creates a link to the innermost active tracer of the calling thread, see @ref onesdk_inprocesslink_create.
+
+        The link is empty if no tracer is active, the agent is not active (see @ref agent_active) or the link is bigger than
+        @ref ONESDK_IN_PROCESS_LINK_BUFFER_SIZE and memory for it can't be allocated.
+    */
+    static in_process_link current() noexcept {
+        in_process_link link;
+        if (agent_active()) {
+            onesdk_size_t required_size = 0;
+            link.m_size = onesdk_inprocesslink_create(link.m_data, sizeof(link.m_data), &required_size);
+            if (required_size > sizeof(link.m_data))
+                link.fetch_large(required_size);
+        }
+        return link;
+    }
+
+    /** @brief Returns `true` if the link is empty. */
+    bool empty() const noexcept { return m_size == 0; }
+
+    /** @brief Returns a pointer to the link data. */
+    unsigned char const* data() const noexcept { return m_large_data ? m_large_data.get() : m_data; }
+
+    /** @brief Returns the size of the link in bytes. */
+    onesdk_size_t size() const noexcept { return m_size; }
+
+private:
+    // The link didn't fit into m_data, fetch it again into a heap buffer of the required size.
+    void fetch_large(onesdk_size_t required_size) noexcept {
+        m_size = 0;
+        try {
+            std::shared_ptr<unsigned char> const data(new unsigned char[required_size], std::default_delete<unsigned char[]>());
+            m_size = onesdk_inprocesslink_create(data.get(), required_size, nullptr);
+            if (m_size != 0)
+                m_large_data = data;
+        } catch (std::bad_alloc const&) {
+        }
+    }
+
+    unsigned char m_data[ONESDK_IN_PROCESS_LINK_BUFFER_SIZE];
+    onesdk_size_t m_size;
+    std::shared_ptr<unsigned char> m_large_data; // Only set for links that don't fit into m_data.
+};
+
+/** @brief Guard for an in-process link tracer, see @ref onesdk_inprocesslinktracer_create. */
+class in_process_link_tracer : public tracer {
+public:
+    in_process_link_tracer() noexcept {}
+
+    in_process_link_tracer(unsigned char const* in_process_link, onesdk_size_t in_process_link_size) noexcept
+        : tracer(agent_active() ? onesdk_inprocesslinktracer_create(in_process_link, in_process_link_size) : ONESDK_INVALID_HANDLE) {}
+
+    /** @brief Creates an in-process link tracer for @p link. No tracer is created if the link is empty. */
+    explicit in_process_link_tracer(in_process_link const& link) noexcept
+        : tracer((!link.empty() && agent_active()) ? onesdk_inprocesslinktracer_create(link.data(), link.size()) : ONESDK_INVALID_HANDLE) {}
+};
+
+/*========================================================================================================================================*/
+
+/** @brief The trace context of a request that is processed in parts (e.g. by the callbacks of an event loop), which can be attached to
+           the thread that runs a part and detached from it before the thread goes on to other work.
+
+    A started tracer stays the active tracer of its thread until it is ended, and tracers must be ended in reverse order of starting them.
+    So an event loop can't keep a request's tracer open while it serves other requests on the same thread. Instead, the request's
+    context is captured as an @ref in_process_link once (e.g. right after starting the incoming request's tracer) and attached while a
+    part of the request runs: an attached context is a started in-process link tracer on the current thread, so the tracers and custom
+    request attributes of that part are linked to the captured tracer.
+
+    @code{.cpp}
+    void on_request(connection& conn) {
+        onesdk::incoming_web_request_tracer tracer(web_app_info, url, method);
+        tracer.start();
+        conn.context = onesdk::request_context::capture();
+        start_backend_call(conn); // callbacks run later, on this thread
+    }   // the incoming web request tracer ends here
+
+    void on_backend_response(connection& conn) {
+        onesdk::request_context::scope const attached(conn.context);
+        onesdk::custom_service_tracer tracer(...); // linked to the incoming web request
+        tracer.start();
+        // ...
+    }   // detached here
+    @endcode
+
+    A context must only be attached and detached by the same thread, and be detached before that thread runs parts of other requests. It is
+    non-copyable but movable. Each attachment creates an in-process link tracer, so the request shows one such tracer per part.
+
+    @note The tracer the context was captured from can only be ended on its own thread in the usual order, so if the request's tracer
+          must not end before the request is complete, its duration is not available in event-loop code. The parts can record their
+          own durations with timed tracers (see @ref onesdk_tracer_start_timed).
+*/
+class request_context {
+public:
+    /** @brief Attaches a @ref request_context for the current scope and detaches it at the end of the scope. */
+    class scope {
+    public:
+        /** @brief Attaches @p context to the calling thread. */
+        explicit scope(request_context& context) noexcept : m_context(context) {
+            m_context.attach();
+        }
+
+        scope(scope const&) = delete; // We're non-copyable.
+        scope& operator =(scope const&) = delete; // We're non-copyable.
+
+        /** @brief Detaches the context. */
+        ~scope() {
+            m_context.detach();
+        }
+
+    private:
+        request_context& m_context;
+    };
+
+    /** @brief Constructs an empty context, which never starts a tracer. */
+    request_context() noexcept : m_link(), m_tracer() {}
+
+    /** @brief Constructs a detached context for @p link. */
+    explicit request_context(in_process_link const& link) noexcept : m_link(link), m_tracer() {}
+
+    request_context(request_context&& other) noexcept : m_link(other.m_link), m_tracer(std::move(other.m_tracer)) {}
+
+    request_context& operator =(request_context&& other) noexcept {
+        if (this != &other) {
+            m_link = other.m_link;
+            m_tracer = std::move(other.m_tracer);
+        }
+        return *this;
+    }
+
+    /** @brief Detaches the context. */
+    ~request_context() {
+        detach();
+    }
+
+    /** @brief Captures the active tracer of the calling thread (see @ref in_process_link::current) into a detached context. */
+    static request_context capture() noexcept {
+        return request_context(in_process_link::current());
+    }
+
+    /** @brief Starts an in-process link tracer for the captured link on the calling thread, if the context isn't already attached. */
+    void attach() noexcept {
+        if (!m_tracer && !m_link.empty()) {
+            m_tracer = in_process_link_tracer(m_link);
+            m_tracer.start();
+        }
+    }
+
+    /** @brief Ends the in-process link tracer that @ref attach started. Does nothing if the context isn't attached. */
+    void detach() noexcept {
+        m_tracer.end();
+    }
+
+    /** @brief Adds custom request attributes to the request, see @ref onesdk_customrequestattribute_add_batch.
+
+        If the context isn't attached, it is attached to the calling thread for this call only. So attributes can be added to the
+        request from any thread that is not running a part of another request at the time.
+    */
+    void add_custom_request_attributes(onesdk_customrequestattribute_t const* attributes, onesdk_size_t count) noexcept {
+        if (count == 0 || m_link.empty())
+            return;
+        bool const was_attached = attached();
+        attach();
+        onesdk_customrequestattribute_add_batch(attributes, count);
+        if (!was_attached)
+            detach();
+    }
+
+    /** @brief Same as @ref add_custom_request_attributes(onesdk_customrequestattribute_t const*, onesdk_size_t) for an array. */
+    template <onesdk_size_t N>
+    void add_custom_request_attributes(onesdk_customrequestattribute_t const (&attributes)[N]) noexcept {
+        add_custom_request_attributes(attributes, N);
+    }
+
+    /** @brief Returns `true` if the context is attached. */
+    bool attached() const noexcept { return static_cast<bool>(m_tracer); }
+
+    /** @brief Returns the captured link (empty if no tracer was active at capture). */
+    in_process_link const& link() const noexcept { return m_link; }
+
+private:
+    in_process_link m_link;
+    in_process_link_tracer m_tracer;
+};
+
+/*========================================================================================================================================*/
+
+} // namespace onesdk
+
+/** @} */
+
+/*========================================================================================================================================*/
+
+#endif /* ONESDK_CPP_H_INCLUDED */
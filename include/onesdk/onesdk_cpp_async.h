@@ -0,0 +1,520 @@
+/*
+    Copyright 2017-2019 Dynatrace LLC
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef ONESDK_CPP_ASYNC_H_INCLUDED
+#define ONESDK_CPP_ASYNC_H_INCLUDED
+
+/** @file
+    @brief Defines header-only C++11 helpers that use background threads, see @ref cpp_async.
+*/
+
+/*========================================================================================================================================*/
+
+#if !defined(__cplusplus)
+#    error onesdk_cpp_async.h can only be used from C++ (C++11 or later).
+#endif
+
+#include "onesdk/onesdk_cpp.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*========================================================================================================================================*/
+
+/** @defgroup cpp_async C++ Asynchronous Submission
+    @brief Moves SDK calls off latency-critical threads.
+
+    @ref onesdk::agent_state_refresher keeps the cached agent state (see @ref onesdk::agent_active) up to date.
+
+    An @ref onesdk::async_submitter owns a worker thread that executes submitted tasks, typically tasks that create, start and end
+    tracers with timestamps that were recorded on the application thread (see @ref onesdk_tracer_start_timed):
+
+    @code{.cpp}
+    onesdk::async_submitter submitter; // create after onesdk_initialize, destroy before onesdk_shutdown
+
+    void handle_request() {
+        auto const start_time = std::chrono::steady_clock::now();
+        process_request();
+        auto const end_time = std::chrono::steady_clock::now();
+
+        submitter.submit([start_time, end_time]() noexcept {
+            onesdk::custom_service_tracer tracer(onesdk_asciistr("handle_request"), onesdk_asciistr("RequestService"));
+            tracer.start(start_time);
+            tracer.end(end_time);
+        });
+    }
+    @endcode
+
+    Each thread that submits tasks gets its own fixed-size single-producer/single-consumer ring buffer, so @ref onesdk::async_submitter::submit
+    doesn't allocate (except for the first submission on a thread) and never waits for the worker. It only takes a lock to wake the worker
+    thread if that sleeps because there was nothing to do. If the ring buffer of a thread is full, the task is dropped and counted (see
+    @ref onesdk::async_submitter::dropped_count).
+
+    Tasks must be trivially copyable and fit into @ref onesdk::async_submitter::task_size bytes. In particular they can't own memory, so
+    any @ref onesdk_string_t a task passes to the SDK must stay valid until the task has run (string literals are always fine).
+
+    @note Tracers created by a task are linked to the active tracer of the worker thread, not to the tracer that was active on the
+          submitting thread. Without further linking (e.g. by tags or in-process links) they become root tracers.
+
+    Tasks that are handed to the application's own thread pools or executors can be linked to the tracer that was active when they were
+    submitted with @ref onesdk::link_task or, for all tasks of an executor, with an @ref onesdk::linking_executor:
+
+    @code{.cpp}
+    // Any callable that accepts a task works as executor, e.g. a lambda that forwards to a thread pool.
+    auto executor = onesdk::make_linking_executor([&pool](std::function<void()> task) { pool.submit(std::move(task)); });
+
+    void handle_request() {
+        onesdk::incoming_web_request_tracer tracer(...);
+        tracer.start();
+        executor([] {
+            onesdk::database_request_tracer db(...); // linked to the incoming web request
+            // ...
+        });
+    }
+    @endcode
+
+    At submission, the link to the active tracer is captured into the task (see @ref onesdk::in_process_link). When the task runs, it starts
+    an in-process link tracer for the link and ends it after the task has returned. If no tracer was active or the agent is not active
+    (see @ref onesdk::agent_active) the link is empty and the task runs without a tracer.
+
+    @note The link is carried by value, so a @ref onesdk::linked_task is more than @ref ONESDK_IN_PROCESS_LINK_BUFFER_SIZE bytes bigger
+          than the wrapped task. Capturing the link doesn't allocate, but a type-erasing wrapper with a small inline buffer, like
+          `std::function`, allocates memory for every linked task (the benchmark in samples/benchmark measures this as the
+          `linked_task_function` family). Executors that take the task type as a template parameter avoid that.
+
+    @{
+*/
+
+namespace onesdk {
+
+/*========================================================================================================================================*/
+
+/** @brief Refreshes the cached agent state (see @ref onesdk::refresh_agent_state) periodically on a background thread.
+
+    @code{.cpp}
+    onesdk_initialize();
+    onesdk::agent_state_refresher refresher; // refreshes once per second until destroyed, destroy before onesdk_shutdown
+    @endcode
+*/
+class agent_state_refresher {
+public:
+    /** @brief Refreshes the cached agent state and starts a thread that refreshes it every @p interval. */
+    explicit agent_state_refresher(std::chrono::milliseconds interval = std::chrono::seconds(1))
+        : m_interval(interval), m_stopping(false), m_thread() {
+        refresh_agent_state();
+        m_thread = std::thread(&agent_state_refresher::run, this);
+    }
+
+    agent_state_refresher(agent_state_refresher const&) = delete; // We're non-copyable.
+    agent_state_refresher& operator =(agent_state_refresher const&) = delete; // We're non-copyable.
+
+    /** @brief Stops the background thread. The cached state keeps its last value. */
+    ~agent_state_refresher() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wakeup.notify_one();
+        m_thread.join();
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_wakeup.wait_for(lock, m_interval, [this] { return m_stopping; }))
+            refresh_agent_state();
+    }
+
+    std::chrono::milliseconds const m_interval;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    bool m_stopping;
+    std::thread m_thread;
+};
+
+/*========================================================================================================================================*/
+
+/** @brief Executes submitted tasks on a worker thread, see @ref cpp_async. */
+class async_submitter {
+public:
+    /** @brief The maximum size of a task in bytes. */
+    static std::size_t const task_size = 96;
+
+    /** @brief The default number of tasks that can be buffered per submitting thread. */
+    static std::size_t const default_ring_capacity = 4096;
+
+    /** @brief Starts the worker thread.
+        @param ring_capacity    The number of tasks that can be buffered per submitting thread. Rounded up to a power of two.
+
+        The worker thread sleeps while all ring buffers are empty. @ref submit only wakes it if it is sleeping, so a busy worker isn't
+        notified for every task.
+    */
+    explicit async_submitter(std::size_t ring_capacity = default_ring_capacity)
+        : m_id(next_id())
+        , m_ring_capacity(round_up_to_power_of_two(ring_capacity))
+        , m_stopping(false)
+        , m_wakeup_pending(false)
+        , m_worker() {
+        m_worker = std::thread(&async_submitter::run, this);
+    }
+
+    async_submitter(async_submitter const&) = delete; // We're non-copyable.
+    async_submitter& operator =(async_submitter const&) = delete; // We're non-copyable.
+
+    /** @brief Stops the worker thread after executing all tasks submitted so far. */
+    ~async_submitter() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wakeup.notify_one();
+        m_worker.join();
+    }
+
+    /** @brief Submits a task for execution on the worker thread.
+        @return `true` if the task was queued, `false` if it was dropped because the ring buffer of the calling thread is full.
+
+        Must not be called concurrently with the destructor.
+    */
+    template <typename Task>
+    bool submit(Task const& task) noexcept {
+        static_assert(std::is_trivially_copyable<Task>::value, "tasks must be trivially copyable");
+        static_assert(sizeof(Task) <= task_size, "tasks must not be larger than async_submitter::task_size");
+        static_assert(alignof(Task) <= alignof(std::max_align_t), "tasks must not be over-aligned");
+
+        ring* const r = ring_for_current_thread();
+        if (r == nullptr) {
+            m_unregistered_drops.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (!r->push(&invoke<Task>, &task, sizeof(Task)))
+            return false;
+        wake_worker();
+        return true;
+    }
+
+    /** @brief Returns the number of tasks that were queued successfully. */
+    unsigned long long submitted_count() const {
+        unsigned long long count = 0;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::shared_ptr<ring> const& r : m_rings)
+            count += r->submitted.load(std::memory_order_relaxed);
+        return count + m_retired_submitted;
+    }
+
+    /** @brief Returns the number of tasks that were dropped because a ring buffer was full (or could not be allocated). */
+    unsigned long long dropped_count() const {
+        unsigned long long count = m_unregistered_drops.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::shared_ptr<ring> const& r : m_rings)
+            count += r->dropped.load(std::memory_order_relaxed);
+        return count + m_retired_dropped;
+    }
+
+    /** @brief Returns the number of tasks that were executed by the worker thread. */
+    unsigned long long executed_count() const {
+        return m_executed.load(std::memory_order_relaxed);
+    }
+
+private:
+    typedef void (*invoke_function)(void const* task);
+
+    template <typename Task>
+    static void invoke(void const* task) {
+        typename std::aligned_storage<sizeof(Task), alignof(Task)>::type storage;
+        std::memcpy(&storage, task, sizeof(Task));
+        try {
+            (*reinterpret_cast<Task*>(&storage))();
+        } catch (...) {
+            // Tasks have no one to report errors to, an exception must not terminate the worker.
+        }
+    }
+
+    struct slot {
+        invoke_function function;
+        alignas(std::max_align_t) unsigned char task[task_size];
+    };
+
+    // Single-producer/single-consumer ring buffer. The producer is the thread that registered it, the consumer is the worker thread.
+    struct ring {
+        explicit ring(std::size_t capacity) : slots(new slot[capacity]), mask(capacity - 1), head(0), tail(0),
+            submitted(0), dropped(0), abandoned(false) {}
+
+        bool push(invoke_function function, void const* task, std::size_t size) noexcept {
+            std::size_t const t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) > mask) {
+                dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
+            }
+            slot& s = slots[t & mask];
+            s.function = function;
+            std::memcpy(s.task, task, size);
+            tail.store(t + 1, std::memory_order_release);
+            submitted.store(submitted.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        std::size_t drain() {
+            std::size_t h = head.load(std::memory_order_relaxed);
+            std::size_t const t = tail.load(std::memory_order_acquire);
+            std::size_t const count = t - h;
+            for (; h != t; h++) {
+                slot const& s = slots[h & mask];
+                s.function(s.task);
+                head.store(h + 1, std::memory_order_release);
+            }
+            return count;
+        }
+
+        bool empty() const noexcept {
+            return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+        }
+
+        std::unique_ptr<slot[]> slots;
+        std::size_t const mask;
+        alignas(64) std::atomic<std::size_t> head;
+        alignas(64) std::atomic<std::size_t> tail;
+        std::atomic<unsigned long long> submitted;
+        std::atomic<unsigned long long> dropped;
+        std::atomic<bool> abandoned;
+    };
+
+    // Per-thread registration, marks the rings of the thread as abandoned when the thread exits. The rings are owned by their submitter,
+    // so they are freed when it is destroyed, and the thread's entries for destroyed submitters are removed when it registers a new ring.
+    struct thread_registration {
+        struct entry {
+            unsigned long long submitter_id;
+            ring* r; // Valid while the submitter is alive, submit must not be called concurrently with the destructor.
+            std::weak_ptr<ring> owned_ring;
+        };
+
+        ~thread_registration() {
+            for (entry const& e : entries) {
+                if (std::shared_ptr<ring> const r = e.owned_ring.lock())
+                    r->abandoned.store(true, std::memory_order_release);
+            }
+        }
+
+        std::vector<entry> entries;
+    };
+
+    static unsigned long long next_id() {
+        static std::atomic<unsigned long long> id(0);
+        return ++id;
+    }
+
+    static std::size_t round_up_to_power_of_two(std::size_t value) {
+        std::size_t result = 1;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+
+    ring* ring_for_current_thread() noexcept {
+        static thread_local thread_registration registration;
+        std::vector<thread_registration::entry>& entries = registration.entries;
+        for (thread_registration::entry const& e : entries) {
+            if (e.submitter_id == m_id)
+                return e.r;
+        }
+
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+            [](thread_registration::entry const& e) { return e.owned_ring.expired(); }), entries.end());
+        try {
+            std::shared_ptr<ring> const r = std::make_shared<ring>(m_ring_capacity);
+            entries.reserve(entries.size() + 1); // So that the push_back below can't fail after the ring was added to m_rings.
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_rings.push_back(r);
+            }
+            entries.push_back(thread_registration::entry{ m_id, r.get(), r });
+            return r.get();
+        } catch (std::bad_alloc const&) {
+            return nullptr;
+        }
+    }
+
+    // Wakes the worker if it is sleeping (or about to). The fence pairs with the one in wait_for_tasks: either the worker sees the task
+    // that was just pushed before it goes to sleep, or this function sees that it sleeps.
+    void wake_worker() noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleeping.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_wakeup_pending = true;
+            m_wakeup.notify_one();
+        }
+    }
+
+    // Sleeps until a task is submitted or the submitter is destroyed.
+    void wait_for_tasks() {
+        m_sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        bool const has_tasks = std::any_of(m_rings.begin(), m_rings.end(), [](std::shared_ptr<ring> const& r) { return !r->empty(); });
+        if (!has_tasks)
+            m_wakeup.wait(lock, [this] { return m_stopping || m_wakeup_pending; });
+        m_wakeup_pending = false;
+        m_sleeping.store(false, std::memory_order_relaxed);
+    }
+
+    void run() {
+        std::vector<std::shared_ptr<ring>> rings;
+        for (;;) {
+            bool stopping;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                stopping = m_stopping;
+                retire_abandoned_rings();
+                rings = m_rings;
+            }
+
+            std::size_t executed = 0;
+            for (std::shared_ptr<ring> const& r : rings)
+                executed += r->drain();
+            m_executed.fetch_add(executed, std::memory_order_relaxed);
+
+            if (stopping)
+                break;
+            if (executed == 0)
+                wait_for_tasks();
+        }
+    }
+
+    // Must be called with m_mutex held. A ring is abandoned when its thread has exited, so it won't receive any more tasks.
+    void retire_abandoned_rings() {
+        for (std::size_t i = 0; i < m_rings.size();) {
+            ring const& r = *m_rings[i];
+            if (r.abandoned.load(std::memory_order_acquire) && r.empty()) {
+                m_retired_submitted += r.submitted.load(std::memory_order_relaxed);
+                m_retired_dropped += r.dropped.load(std::memory_order_relaxed);
+                m_rings[i] = std::move(m_rings.back());
+                m_rings.pop_back();
+            } else {
+                i++;
+            }
+        }
+    }
+
+    unsigned long long const m_id;
+    std::size_t const m_ring_capacity;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    bool m_stopping;
+    bool m_wakeup_pending;
+    std::atomic<bool> m_sleeping{ false };
+    std::vector<std::shared_ptr<ring>> m_rings;
+    unsigned long long m_retired_submitted = 0;
+    unsigned long long m_retired_dropped = 0;
+    std::atomic<unsigned long long> m_unregistered_drops{ 0 };
+    std::atomic<unsigned long long> m_executed{ 0 };
+
+    std::thread m_worker;
+};
+
+/*========================================================================================================================================*/
+
+/** @brief A task that runs inside an in-process link tracer, see @ref link_task.
+
+    Stores the task and the @ref in_process_link by value (see the note in @ref cpp_async about its size).
+*/
+template <typename Task>
+class linked_task {
+public:
+    /** @brief Wraps @p task, which will be linked to the tracer @p link was created for. */
+    linked_task(Task task, in_process_link const& link) : m_task(std::move(task)), m_link(link) {}
+
+    /** @brief Calls the task while an in-process link tracer for the captured link is active.
+
+        If the task throws, the exception is set as error of the in-process link tracer (see
+        @ref tracer::error_from_current_exception) and rethrown. If the link is empty, the task is called without a tracer.
+    */
+    template <typename... Args>
+    auto operator ()(Args&&... args) -> decltype(std::declval<Task&>()(std::forward<Args>(args)...)) {
+        in_process_link_tracer tracer(m_link);
+        tracer.start();
+        try {
+            return m_task(std::forward<Args>(args)...);
+        } catch (...) {
+            tracer.error_from_current_exception();
+            throw;
+        }
+    }
+
+    /** @brief Returns the captured link. */
+    in_process_link const& link() const noexcept { return m_link; }
+
+private:
+    Task m_task;
+    in_process_link m_link;
+};
+
+/** @brief Links @p task to the active tracer of the calling thread, see @ref cpp_async.
+
+    The returned @ref linked_task can be run on any thread, any number of times.
+*/
+template <typename Task>
+linked_task<typename std::decay<Task>::type> link_task(Task&& task) {
+    return linked_task<typename std::decay<Task>::type>(std::forward<Task>(task), in_process_link::current());
+}
+
+/** @brief Wraps an executor so that every task submitted through it is linked to the tracer that was active at submission.
+
+    @p Executor can be any callable that accepts a task, e.g. a lambda that forwards to a thread pool. It receives a @ref linked_task,
+    which is copyable if the original task is (as needed for `std::function`).
+*/
+template <typename Executor>
+class linking_executor {
+public:
+    /** @brief Wraps @p executor. */
+    explicit linking_executor(Executor executor) : m_executor(std::move(executor)) {}
+
+    /** @brief Submits @p task, linked to the active tracer of the calling thread, to the wrapped executor and returns its result. */
+    template <typename Task>
+    auto operator ()(Task&& task) -> decltype(std::declval<Executor&>()(link_task(std::forward<Task>(task)))) {
+        return m_executor(link_task(std::forward<Task>(task)));
+    }
+
+    /** @brief Returns the wrapped executor. */
+    Executor& executor() noexcept { return m_executor; }
+
+private:
+    Executor m_executor;
+};
+
+/** @brief Creates a @ref linking_executor for @p executor. */
+template <typename Executor>
+linking_executor<typename std::decay<Executor>::type> make_linking_executor(Executor&& executor) {
+    return linking_executor<typename std::decay<Executor>::type>(std::forward<Executor>(executor));
+}
+
+} // namespace onesdk
+
+/** @} */
+
+#endif /* ONESDK_CPP_ASYNC_H_INCLUDED */
@@ -0,0 +1,199 @@
+/*
+    Copyright 2017-2019 Dynatrace LLC
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef ONESDK_CPP_COROUTINE_H_INCLUDED
+#define ONESDK_CPP_COROUTINE_H_INCLUDED
+
+/** @file
+    @brief Defines header-only C++20 helpers for tracing coroutines, see @ref cpp_coroutine.
+*/
+
+/*========================================================================================================================================*/
+
+#if !defined(__cplusplus)
+#    error onesdk_cpp_coroutine.h can only be used from C++ (C++20 or later).
+#endif
+
+#if !defined(__cpp_impl_coroutine) || !defined(__has_include)
+#    error onesdk_cpp_coroutine.h requires C++20 coroutine support.
+#elif !__has_include(<coroutine>)
+#    error onesdk_cpp_coroutine.h requires C++20 coroutine support.
+#endif
+
+#include "onesdk/onesdk_cpp.h"
+
+#include <coroutine>
+#include <exception>
+#include <type_traits>
+#include <utility>
+
+/*========================================================================================================================================*/
+
+/** @defgroup cpp_coroutine C++20 Coroutine Helpers
+    @brief Keeps tracers of coroutines linked to their logical request across suspension points.
+
+    The SDK links new tracers and custom request attributes to the active tracer of the calling thread. A coroutine that suspends can be
+    resumed on another thread, and the thread it ran on goes on to run other coroutines, so the thread's active tracer doesn't identify
+    the coroutine's request. Tracers also can't stay active across a suspension point, since they must be ended on the thread that
+    created them.
+
+    An @ref onesdk::coroutine_context (a @ref onesdk::request_context) captures the active tracer of the coroutine when it is created (as
+    an @ref onesdk::in_process_link) and is active (attached) while the coroutine runs: an active context is an in-process link tracer on
+    the current thread, so tracers and custom request attributes of the coroutine are linked to the captured tracer. Awaiting through
+    @ref onesdk::with_context deactivates the context before the coroutine suspends and activates it again (on whatever thread) when it
+    resumes:
+
+    @code{.cpp}
+    task<std::string> handle_request(request req) {
+        // Created while the incoming web request tracer of req is active on this thread.
+        onesdk::coroutine_context context = onesdk::coroutine_context::capture();
+        onesdk::context_scope const scope(context);
+
+        auto const start_time = std::chrono::steady_clock::now();
+        std::string const value = co_await onesdk::with_context(context, cache.get(req.key()));
+
+        // Tracers are created between suspension points. Operations that span one are traced with timestamps.
+        onesdk::outgoing_remote_call_tracer tracer(...);
+        tracer.start(start_time);
+        onesdk_customrequestattribute_add_string(onesdk_asciistr("cache.key"), onesdk::utf8str(req.key()));
+        co_return value;
+    }
+    @endcode
+
+    Each activation creates an in-process link tracer, so the request shows one such tracer per resumption of the coroutine.
+
+    @ref onesdk::with_context and @ref onesdk::context_scope accept any @ref onesdk::request_context, so contexts that are shared with
+    callback-based code work as well.
+
+    @{
+*/
+
+namespace onesdk {
+
+/*========================================================================================================================================*/
+
+/** @brief The trace context of a coroutine, see @ref cpp_coroutine.
+
+    A @ref request_context that uses the coroutine terms: @ref activate, @ref deactivate and @ref active are the same as
+    @ref request_context::attach, @ref request_context::detach and @ref request_context::attached. A context must only be activated and
+    deactivated by the thread that currently runs the coroutine. It is non-copyable but movable, so that it can be handed to the coroutine
+    that continues the request.
+*/
+class coroutine_context : public request_context {
+public:
+    /** @brief Constructs an empty context, which never activates a tracer. */
+    coroutine_context() noexcept {}
+
+    /** @brief Constructs an inactive context for @p link. */
+    explicit coroutine_context(in_process_link const& link) noexcept : request_context(link) {}
+
+    /** @brief Captures the active tracer of the calling thread (see @ref in_process_link::current) into an inactive context. */
+    static coroutine_context capture() noexcept {
+        return coroutine_context(in_process_link::current());
+    }
+
+    /** @brief Same as @ref request_context::attach. */
+    void activate() noexcept { attach(); }
+
+    /** @brief Same as @ref request_context::detach. */
+    void deactivate() noexcept { detach(); }
+
+    /** @brief Same as @ref request_context::attached. */
+    bool active() const noexcept { return attached(); }
+};
+
+/** @brief Activates a @ref coroutine_context (or any @ref request_context) for the current scope, see @ref request_context::scope. */
+typedef request_context::scope context_scope;
+
+/*========================================================================================================================================*/
+
+/** @internal */
+namespace detail {
+
+/** @internal */
+template <typename Awaitable>
+decltype(auto) get_awaiter(Awaitable&& awaitable) {
+    if constexpr (requires { std::forward<Awaitable>(awaitable).operator co_await(); })
+        return std::forward<Awaitable>(awaitable).operator co_await();
+    else if constexpr (requires { operator co_await(std::forward<Awaitable>(awaitable)); })
+        return operator co_await(std::forward<Awaitable>(awaitable));
+    else
+        return std::forward<Awaitable>(awaitable);
+}
+
+/** @internal References to lvalue awaiters are kept, everything else is stored by value. */
+template <typename Awaitable>
+using awaiter_storage_t = std::conditional_t<std::is_lvalue_reference_v<decltype(get_awaiter(std::declval<Awaitable>()))>,
+    decltype(get_awaiter(std::declval<Awaitable>())), std::remove_cvref_t<decltype(get_awaiter(std::declval<Awaitable>()))>>;
+
+} // namespace detail
+
+/** @brief An awaiter that deactivates a @ref coroutine_context while the awaiting coroutine is suspended, see @ref with_context. */
+template <typename Awaitable>
+class context_awaiter {
+public:
+    /** @brief Wraps @p awaitable. */
+    context_awaiter(request_context& context, Awaitable&& awaitable)
+        : m_context(context), m_awaiter(detail::get_awaiter(std::forward<Awaitable>(awaitable))) {}
+
+    /** @brief Forwards to the wrapped awaitable. */
+    bool await_ready() {
+        return m_awaiter.await_ready();
+    }
+
+    /** @brief Deactivates the context on this thread, before the coroutine can be resumed anywhere else. */
+    template <typename Promise>
+    decltype(auto) await_suspend(std::coroutine_handle<Promise> handle) {
+        bool const was_attached = m_context.attached();
+        m_context.detach();
+        try {
+            return m_awaiter.await_suspend(handle);
+        } catch (...) {
+            // The coroutine continues on this thread with the exception.
+            if (was_attached)
+                m_context.attach();
+            throw;
+        }
+    }
+
+    /** @brief Activates the context on the resuming thread and returns the result of the wrapped awaitable. */
+    decltype(auto) await_resume() {
+        m_context.attach();
+        return m_awaiter.await_resume();
+    }
+
+private:
+    request_context& m_context;
+    detail::awaiter_storage_t<Awaitable> m_awaiter;
+};
+
+/** @brief Awaits @p awaitable with @p context deactivated while the coroutine is suspended, see @ref cpp_coroutine.
+
+    The context is activated when the `co_await` expression returns (unless it is empty or the agent is not active), even if it wasn't
+    active before.
+*/
+template <typename Awaitable>
+context_awaiter<Awaitable> with_context(request_context& context, Awaitable&& awaitable) {
+    return context_awaiter<Awaitable>(context, std::forward<Awaitable>(awaitable));
+}
+
+} // namespace onesdk
+
+/** @} */
+
+/*========================================================================================================================================*/
+
+#endif /* ONESDK_CPP_COROUTINE_H_INCLUDED */
@@ -0,0 +1,232 @@
+/*
+    Copyright 2017-2019 Dynatrace LLC
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef ONESDK_CPP_SQL_H_INCLUDED
+#define ONESDK_CPP_SQL_H_INCLUDED
+
+/** @file
+    @brief Defines header-only C++11 helpers for database request tracers, see @ref cpp_sql.
+*/
+
+/*========================================================================================================================================*/
+
+#if !defined(__cplusplus)
+#    error onesdk_cpp_sql.h can only be used from C++ (C++11 or later).
+#endif
+
+#include "onesdk/onesdk_agent.h"
+#include "onesdk/onesdk_cpp.h"
+#include "onesdk/onesdk_string.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/*========================================================================================================================================*/
+
+/** @defgroup cpp_sql C++ SQL Statement Helpers
+    @brief Helpers for passing SQL statements to database request tracers.
+
+    Applications that build SQL statements containing literal values (instead of using bind parameters) pass a different statement text
+    to @ref onesdk_databaserequesttracer_create_sql for every request. An @ref onesdk::sql_statement_cache replaces string and numeric
+    literals with `?`, so that all requests with the same statement shape are traced with the same statement text, and keeps the most
+    recently used shapes:
+
+    @code{.cpp}
+    static onesdk::sql_statement_cache statement_cache(256);
+
+    std::string const sql = "SELECT value FROM config_values WHERE name = '" + sql_escape(name) + "'";
+    onesdk::database_request_tracer tracer(statement_cache.create_tracer(db_info_handle, sql)); // "... WHERE name = ?"
+    @endcode
+
+    Normalization also keeps literal values (which might contain sensitive data) from being passed to the agent.
+
+    @note Normalization is not free: every call scans and hashes the whole statement and locks the cache. It doesn't make tracing a
+          statement cheaper than passing it to @ref onesdk_databaserequesttracer_create_sql directly.
+
+    @{
+*/
+
+namespace onesdk {
+
+/*========================================================================================================================================*/
+
+/** @brief A bounded, thread-safe LRU cache of normalized SQL statements, see @ref cpp_sql. */
+class sql_statement_cache {
+public:
+    /** @brief The default maximum number of statement shapes that are kept. */
+    static std::size_t const default_capacity = 1024;
+
+    /** @brief Constructs an empty cache.
+        @param capacity     The maximum number of statement shapes that are kept. Must be at least one.
+    */
+    explicit sql_statement_cache(std::size_t capacity = default_capacity) : m_capacity(capacity ? capacity : 1) {}
+
+    sql_statement_cache(sql_statement_cache const&) = delete; // We're non-copyable.
+    sql_statement_cache& operator =(sql_statement_cache const&) = delete; // We're non-copyable.
+
+    /** @brief Returns the normalized form of an SQL statement.
+        @param sql          Pointer to the statement text (ASCII or UTF-8).
+        @param sql_length   Length of the statement text in bytes.
+
+        String literals (`'...'`, in which both `''` and `\'` are escaped quotes) and numeric literals are replaced with `?`. Quoted
+        identifiers, bind parameters (`?`, `:name`, `:1`, `$1`, `@p1`) and everything else are kept as they are.
+        If the same statement shape is already cached, the cached string is returned and moved to the front of the LRU list, otherwise
+        it is added to the cache, evicting the least recently used shape if the cache is full.
+
+        @exception std::bad_alloc if memory can't be allocated.
+    */
+    std::shared_ptr<std::string const> normalize(char const* sql, std::size_t sql_length) {
+        static thread_local std::string normalized;
+        std::uint64_t const hash = normalize(sql, sql_length, normalized);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto const found = m_index.find(hash);
+        if (found != m_index.end() && *found->second->statement == normalized) {
+            m_entries.splice(m_entries.begin(), m_entries, found->second);
+            return found->second->statement;
+        }
+
+        std::shared_ptr<std::string const> const statement = std::make_shared<std::string const>(normalized);
+        if (found != m_index.end()) {
+            // Hash collision, the new shape replaces the cached one.
+            found->second->statement = statement;
+            m_entries.splice(m_entries.begin(), m_entries, found->second);
+            return statement;
+        }
+
+        if (m_entries.size() >= m_capacity) {
+            m_index.erase(m_entries.back().hash);
+            m_entries.pop_back();
+        }
+        m_entries.push_front(entry{ hash, statement });
+        m_index[hash] = m_entries.begin();
+        return statement;
+    }
+
+    /** @brief Same as @ref normalize(char const*, std::size_t) for a `std::string`. */
+    std::shared_ptr<std::string const> normalize(std::string const& sql) {
+        return normalize(sql.data(), sql.size());
+    }
+
+    /** @brief Creates a database request tracer for the normalized form of @p sql, see @ref onesdk_databaserequesttracer_create_sql.
+
+        Returns @ref ONESDK_INVALID_HANDLE without normalizing the statement if @p databaseinfo_handle is invalid, the agent is not active
+        (see @ref onesdk::agent_active) or memory can't be allocated.
+    */
+    onesdk_tracer_handle_t create_tracer(onesdk_databaseinfo_handle_t databaseinfo_handle, std::string const& sql) noexcept {
+        if (databaseinfo_handle == ONESDK_INVALID_HANDLE || !agent_active())
+            return ONESDK_INVALID_HANDLE;
+        try {
+            std::shared_ptr<std::string const> const statement = normalize(sql);
+            return onesdk_databaserequesttracer_create_sql(databaseinfo_handle,
+                onesdk_str(statement->data(), statement->size(), ONESDK_CCSID_UTF8));
+        } catch (...) {
+            return ONESDK_INVALID_HANDLE;
+        }
+    }
+
+    /** @brief Returns the number of cached statement shapes. */
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+
+private:
+    struct entry {
+        std::uint64_t hash;
+        std::shared_ptr<std::string const> statement;
+    };
+
+    static bool is_identifier_char(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '$' ||
+            static_cast<unsigned char>(c) >= 0x80;
+    }
+
+    static bool is_number_char(char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '.' || c == '_';
+    }
+
+    // Writes the normalized statement to out and returns its FNV-1a hash.
+    static std::uint64_t normalize(char const* sql, std::size_t sql_length, std::string& out) {
+        out.clear();
+        out.reserve(sql_length);
+        std::size_t i = 0;
+        while (i < sql_length) {
+            char const c = sql[i];
+            if (c == '\'') {
+                // String literal, '' and \' are escaped quotes.
+                for (i++; i < sql_length; i++) {
+                    if (sql[i] == '\\') {
+                        i++;
+                    } else if (sql[i] == '\'') {
+                        if (i + 1 < sql_length && sql[i + 1] == '\'')
+                            i++;
+                        else
+                            break;
+                    }
+                }
+                i++;
+                out += '?';
+            } else if (c == '"' || c == '`') {
+                // Quoted identifier, kept as it is.
+                std::size_t const begin = i;
+                for (i++; i < sql_length && sql[i] != c; i++) {}
+                i++;
+                out.append(sql + begin, (i < sql_length ? i : sql_length) - begin);
+            } else if ((c == ':' || c == '$' || c == '@') && i + 1 < sql_length && is_identifier_char(sql[i + 1])) {
+                // Bind parameter (e.g. :name, :1, $1, @p1), kept as it is.
+                std::size_t const begin = i;
+                for (i++; i < sql_length && is_identifier_char(sql[i]); i++) {}
+                out.append(sql + begin, i - begin);
+            } else if (c >= '0' && c <= '9' && (i == 0 || !is_identifier_char(sql[i - 1]))) {
+                // Numeric literal (including e.g. 1.5e3 and 0x1F).
+                for (i++; i < sql_length; i++) {
+                    if ((sql[i] == '+' || sql[i] == '-') && (sql[i - 1] == 'e' || sql[i - 1] == 'E'))
+                        continue;
+                    if (!is_number_char(sql[i]))
+                        break;
+                }
+                out += '?';
+            } else {
+                out += c;
+                i++;
+            }
+        }
+
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (char const c : out)
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+        return hash;
+    }
+
+    std::size_t const m_capacity;
+    mutable std::mutex m_mutex;
+    std::list<entry> m_entries; // Most recently used first.
+    std::unordered_map<std::uint64_t, std::list<entry>::iterator> m_index;
+};
+
+} // namespace onesdk
+
+/** @} */
+
+/*========================================================================================================================================*/
+
+#endif /* ONESDK_CPP_SQL_H_INCLUDED */
@@ -0,0 +1,179 @@
+/*
+    Copyright 2017-2019 Dynatrace LLC
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef ONESDK_CPP_STRING_H_INCLUDED
+#define ONESDK_CPP_STRING_H_INCLUDED
+
+/** @file
+    @brief Defines header-only C++11 helpers for building @ref onesdk_string_t values, see @ref cpp_strings.
+*/
+
+/*========================================================================================================================================*/
+
+#if !defined(__cplusplus)
+#    error onesdk_cpp_string.h can only be used from C++ (C++11 or later).
+#endif
+
+#include "onesdk/onesdk_string.h"
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#    include <string_view>
+#    define ONESDK_CPP_HAS_STRING_VIEW 1
+#endif
+
+/*========================================================================================================================================*/
+
+/** @defgroup cpp_strings C++ String Helpers
+    @brief Helpers for building @ref onesdk_string_t values from C++.
+
+    @{
+*/
+
+namespace onesdk {
+
+/*========================================================================================================================================*/
+
+/** @internal */
+namespace detail {
+
+// Returns the index of the first null character in [begin, end), or end. Splits the range in halves so that the recursion depth stays
+// logarithmic when this is evaluated at compile time.
+template <typename Char>
+constexpr std::size_t find_null(Char const* str, std::size_t begin, std::size_t end) {
+    return (end - begin <= 1)
+        ? ((begin < end && str[begin] != Char()) ? end : begin)
+        : (find_null(str, begin, begin + (end - begin) / 2) != begin + (end - begin) / 2)
+            ? find_null(str, begin, begin + (end - begin) / 2)
+            : find_null(str, begin + (end - begin) / 2, end);
+}
+
+template <typename T>
+struct is_char_pointer : std::integral_constant<bool, std::is_same<T, char const*>::value || std::is_same<T, char*>::value> {};
+
+template <typename T>
+struct is_char16_pointer : std::integral_constant<bool, std::is_same<T, char16_t const*>::value || std::is_same<T, char16_t*>::value> {};
+
+} // namespace detail
+
+/*========================================================================================================================================*/
+
+/** @name String Constructors
+    @brief C++ counterparts of @ref onesdk_asciistr, @ref onesdk_utf8str and @ref onesdk_utf16str that avoid scanning for the terminating
+           null character.
+
+    The overloads for `char` and `char16_t` arrays (which includes string literals) compute the length at compile time if used in a
+    constant expression, and otherwise only scan the array up to its known size. The overloads for `std::string`, `std::u16string` and
+    their `string_view` counterparts (C++17) use `size()`. The overloads for pointers behave like the C functions.
+
+    @code{.cpp}
+    constexpr onesdk_string_t error_class = onesdk::asciistr("std::exception");
+    onesdk_tracer_error(tracer, error_class, onesdk::utf8str(message)); // message is a std::string
+    @endcode
+
+    @note The returned @ref onesdk_string_t points to the data of the argument, it must not be used after the argument was destroyed or
+          modified.
+    @{
+*/
+
+/** @brief Creates a @ref onesdk_string_t for an ASCII string stored in a `char` array (e.g. a string literal). */
+template <std::size_t N>
+constexpr onesdk_string_t asciistr(char const (&str)[N]) noexcept {
+    return onesdk_string_t{ str, static_cast<onesdk_size_t>(detail::find_null(str, 0, N)), ONESDK_CCSID_ASCII };
+}
+
+/** @brief Creates a @ref onesdk_string_t for a UTF-8 string stored in a `char` array (e.g. a string literal). */
+template <std::size_t N>
+constexpr onesdk_string_t utf8str(char const (&str)[N]) noexcept {
+    return onesdk_string_t{ str, static_cast<onesdk_size_t>(detail::find_null(str, 0, N)), ONESDK_CCSID_UTF8 };
+}
+
+/** @brief Same as @ref onesdk_asciistr. */
+template <typename CharPointer, typename std::enable_if<detail::is_char_pointer<CharPointer>::value, int>::type = 0>
+onesdk_string_t asciistr(CharPointer const& str) noexcept {
+    return onesdk_asciistr(str);
+}
+
+/** @brief Same as @ref onesdk_utf8str. */
+template <typename CharPointer, typename std::enable_if<detail::is_char_pointer<CharPointer>::value, int>::type = 0>
+onesdk_string_t utf8str(CharPointer const& str) noexcept {
+    return onesdk_utf8str(str);
+}
+
+/** @brief Creates a @ref onesdk_string_t for an ASCII `std::string`. */
+inline onesdk_string_t asciistr(std::string const& str) noexcept {
+    return onesdk_str(str.data(), static_cast<onesdk_size_t>(str.size()), ONESDK_CCSID_ASCII);
+}
+
+/** @brief Creates a @ref onesdk_string_t for a UTF-8 `std::string`. */
+inline onesdk_string_t utf8str(std::string const& str) noexcept {
+    return onesdk_str(str.data(), static_cast<onesdk_size_t>(str.size()), ONESDK_CCSID_UTF8);
+}
+
+#if defined(ONESDK_CPP_HAS_STRING_VIEW) || defined(ONESDK_BUILD_DOC)
+
+/** @brief Creates a @ref onesdk_string_t for an ASCII `std::string_view` (C++17). */
+constexpr onesdk_string_t asciistr(std::string_view str) noexcept {
+    return onesdk_string_t{ str.data(), static_cast<onesdk_size_t>(str.size()), ONESDK_CCSID_ASCII };
+}
+
+/** @brief Creates a @ref onesdk_string_t for a UTF-8 `std::string_view` (C++17). */
+constexpr onesdk_string_t utf8str(std::string_view str) noexcept {
+    return onesdk_string_t{ str.data(), static_cast<onesdk_size_t>(str.size()), ONESDK_CCSID_UTF8 };
+}
+
+#endif
+
+/** @brief Creates a @ref onesdk_string_t for a UTF-16 string stored in a `char16_t` array (e.g. a `u""` string literal). */
+template <std::size_t N>
+constexpr onesdk_string_t utf16str(char16_t const (&str)[N]) noexcept {
+    return onesdk_string_t{ str, static_cast<onesdk_size_t>(detail::find_null(str, 0, N) * 2), ONESDK_CCSID_UTF16_NATIVE };
+}
+
+/** @brief Creates a @ref onesdk_string_t for a null-terminated UTF-16 `char16_t` string. */
+template <typename Char16Pointer, typename std::enable_if<detail::is_char16_pointer<Char16Pointer>::value, int>::type = 0>
+onesdk_string_t utf16str(Char16Pointer const& str) noexcept {
+    return onesdk_str(str, str ? static_cast<onesdk_size_t>(std::char_traits<char16_t>::length(str) * 2) : 0, ONESDK_CCSID_UTF16_NATIVE);
+}
+
+/** @brief Creates a @ref onesdk_string_t for a UTF-16 `std::u16string`. */
+inline onesdk_string_t utf16str(std::u16string const& str) noexcept {
+    return onesdk_str(str.data(), static_cast<onesdk_size_t>(str.size() * 2), ONESDK_CCSID_UTF16_NATIVE);
+}
+
+#if defined(ONESDK_CPP_HAS_STRING_VIEW) || defined(ONESDK_BUILD_DOC)
+
+/** @brief Creates a @ref onesdk_string_t for a UTF-16 `std::u16string_view` (C++17). */
+constexpr onesdk_string_t utf16str(std::u16string_view str) noexcept {
+    return onesdk_string_t{ str.data(), static_cast<onesdk_size_t>(str.size() * 2), ONESDK_CCSID_UTF16_NATIVE };
+}
+
+#endif
+
+/** @} */
+
+/*========================================================================================================================================*/
+
+} // namespace onesdk
+
+/** @} */
+
+/*========================================================================================================================================*/
+
+#endif /* ONESDK_CPP_STRING_H_INCLUDED */
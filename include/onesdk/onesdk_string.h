@@ -86,6 +86,10 @@ typedef struct onesdk_string {
 
 /** @hideinitializer @brief CCSID for UTF-16 text with the native endianness
     (either @ref ONESDK_CCSID_UTF16_LE or @ref ONESDK_CCSID_UTF16_BE).
+
+    All of the CCSIDs above are supported on all platforms. The stub passes string data to the agent as it is, so an application that
+    stores text as UTF-16 (e.g. in `char16_t` strings) can pass it with this CCSID directly, without converting it to UTF-8 first. See
+    @ref onesdk_utf16str.
 */
 #if defined(ONESDK_BUILD_DOC)
 #define ONESDK_CCSID_UTF16_NATIVE
@@ -161,6 +165,63 @@ ONESDK_DEFINE_INLINE_FUNCTION(onesdk_string_t) onesdk_utf8str(char const* data)
     return onesdk_bytestr(data, ONESDK_CCSID_UTF8);
 }
 
+/** @brief Creates a @ref onesdk_string_t for an ASCII string literal without calling `strlen`.
+    @param literal  A string literal.
+
+    @return A @ref onesdk_string_t that points to the string literal.
+
+    The length of the string is computed at compile time as `sizeof(literal) - 1`. Passing anything other than a string literal (e.g. a
+    `char` pointer) is a compile-time error. In C++11 and later the result is a constant expression.
+
+    @see @ref onesdk_asciistr
+*/
+#define ONESDK_ASCIISTR_LITERAL(literal) ONESDK_STRING_LITERAL_(literal, ONESDK_CCSID_ASCII)
+
+/** @brief Creates a @ref onesdk_string_t for a UTF-8 string literal without calling `strlen`.
+    @param literal  A string literal.
+
+    @return A @ref onesdk_string_t that points to the string literal.
+
+    The length of the string is computed at compile time as `sizeof(literal) - 1`. Passing anything other than a string literal (e.g. a
+    `char` pointer) is a compile-time error. In C++11 and later the result is a constant expression.
+
+    @see @ref onesdk_utf8str
+*/
+#define ONESDK_UTF8STR_LITERAL(literal) ONESDK_STRING_LITERAL_(literal, ONESDK_CCSID_UTF8)
+
+/** @cond */
+#if defined(__cplusplus) && (__cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900))
+#define ONESDK_STRING_LITERAL_(literal, ccsid) (onesdk_string_t{ "" literal "", (onesdk_size_t)(sizeof("" literal "") - 1), ccsid })
+#else
+#define ONESDK_STRING_LITERAL_(literal, ccsid) onesdk_str("" literal "", (onesdk_size_t)(sizeof("" literal "") - 1), ccsid)
+#endif
+/** @endcond */
+
+#if defined(ONESDK_CCSID_UTF16_NATIVE) || defined(ONESDK_BUILD_DOC)
+
+/** @brief Creates a @ref onesdk_string_t for a UTF-16 string using the native endianness.
+    @param data     Pointer to the UTF-16 string data. Must be `NULL` or point to a buffer that is terminated by a code unit with value
+                    zero.
+
+    @return A @ref onesdk_string_t that points to the string.
+
+    Unlike @ref onesdk_wstr this function is available on all platforms. It computes the length of the string by searching for the
+    terminating zero code unit and then builds the return value by calling `onesdk_str(data, byte_length, ONESDK_CCSID_UTF16_NATIVE)`.
+    The string data is not converted, neither by this function nor by the stub.
+
+    @see @ref onesdk_str
+*/
+ONESDK_DEFINE_INLINE_FUNCTION(onesdk_string_t) onesdk_utf16str(uint16_t const* data) {
+    onesdk_size_t length = 0;
+    if (data) {
+        while (data[length] != 0)
+            length++;
+    }
+    return onesdk_str(data, length * 2, ONESDK_CCSID_UTF16_NATIVE);
+}
+
+#endif
+
 /** @brief Creates a @ref onesdk_string_t designating a "null string".
 
     @return `onesdk_str(NULL, 0, ONESDK_CCSID_NULL)`
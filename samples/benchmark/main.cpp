@@ -0,0 +1,512 @@
+/*
+    Copyright 2017-2019 Dynatrace LLC
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+// Overhead benchmark for SDK calls.
+//
+// Every tracer family (and the other per-request SDK calls) runs a typical call sequence in a tight loop. For each family the time and
+// the number of C++ heap allocations per iteration are printed, for 1 thread and for increasing numbers of threads running the same
+// loop concurrently. This is done in up to three modes:
+//
+// - inactive:  the SDK is not initialized, i.e. the cost in a process without an agent.
+// - active:    the SDK is initialized. Without a OneAgent the stand-in agent from samples/standin_agent is used.
+// - forkable:  the SDK is initialized with ONESDK_INIT_FLAG_FORKABLE and the loops run in a forked child process.
+//
+// Usage: benchmark [iterations] [--mode=all|inactive|active|forkable] [--threads=1,2,4,...] [--family=<name>] [--dt_...]
+//
+// Build with optimizations enabled (e.g. CMAKE_BUILD_TYPE=Release). The "custom_service" and "custom_service_guard" families run the
+// same calls with and without the C++ guards from onesdk_cpp.h, their numbers should be the same within measurement noise. The same
+// holds for "in_process_link" and "in_process_link_guard" (which uses onesdk::in_process_link). "task_function" and
+// "linked_task_function" wrap a task in a std::function and run it, without and with onesdk::link_task; the difference shows the cost
+// of carrying the in-process link in the task (including the allocation std::function needs for the bigger object).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "onesdk/onesdk.h"
+#include "onesdk/onesdk_cpp.h"
+#include "onesdk/onesdk_cpp_async.h"
+
+/*========================================================================================================================================*/
+// Allocation counting. Replacing the global operator new also counts allocations made by C++ code in the agent module.
+
+namespace {
+thread_local unsigned long long t_allocations = 0;
+}
+
+void* operator new(std::size_t size) {
+    t_allocations++;
+    void* const p = malloc(size ? size : 1);
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept {
+    t_allocations++;
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept {
+    t_allocations++;
+    return malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+/*========================================================================================================================================*/
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+unsigned long long const default_iterations = 100000;
+unsigned const error_interval = 1024;
+unsigned const rounds = 3;
+
+// Objects shared by all iterations, created after initializing the SDK.
+onesdk_databaseinfo_handle_t g_databaseinfo = ONESDK_INVALID_HANDLE;
+onesdk_webapplicationinfo_handle_t g_webapplicationinfo = ONESDK_INVALID_HANDLE;
+onesdk_messagingsysteminfo_handle_t g_messagingsysteminfo = ONESDK_INVALID_HANDLE;
+char g_incoming_tag[ONESDK_DYNATRACE_STRING_TAG_BUFFER_SIZE] = "";
+
+void do_work(unsigned long long i) {
+    if (i % error_interval == 0)
+        throw std::runtime_error("simulated error");
+}
+
+/*----------------------------------------------------------------------------------------------------------------------------------------*/
+// Families
+
+void run_outgoing_remote_call(unsigned long long) {
+    onesdk_tracer_handle_t const tracer = onesdk_outgoingremotecalltracer_create(
+        onesdk_asciistr("get_price"), onesdk_asciistr("PriceService"), onesdk_asciistr("price-service"),
+        ONESDK_CHANNEL_TYPE_TCP_IP, onesdk_asciistr("price-service:8080"));
+    onesdk_outgoingremotecalltracer_set_protocol_name(tracer, onesdk_asciistr("gRPC"));
+    onesdk_tracer_start(tracer);
+    char tag[ONESDK_DYNATRACE_STRING_TAG_BUFFER_SIZE];
+    onesdk_tracer_get_outgoing_dynatrace_string_tag(tracer, tag, sizeof(tag), NULL);
+    onesdk_tracer_end(tracer);
+}
+
+void run_incoming_remote_call(unsigned long long) {
+    onesdk_tracer_handle_t const tracer = onesdk_incomingremotecalltracer_create(
+        onesdk_asciistr("get_price"), onesdk_asciistr("PriceService"), onesdk_asciistr("price-service"));
+    onesdk_tracer_set_incoming_dynatrace_string_tag(tracer, onesdk_asciistr(g_incoming_tag));
+    onesdk_tracer_start(tracer);
+    onesdk_tracer_end(tracer);
+}
+
+void run_database_request(unsigned long long) {
+    onesdk_tracer_handle_t const tracer = onesdk_databaserequesttracer_create_sql(
+        g_databaseinfo, onesdk_asciistr("SELECT price FROM prices WHERE id = ?"));
+    onesdk_tracer_start(tracer);
+    onesdk_databaserequesttracer_set_returned_row_count(tracer, 1);
+    onesdk_databaserequesttracer_set_round_trip_count(tracer, 1);
+    onesdk_tracer_end(tracer);
+}
+
+void run_incoming_web_request(unsigned long long) {
+    static onesdk_string_t const header_names[] = { onesdk_asciistr("Host"), onesdk_asciistr("User-Agent") };
+    static onesdk_string_t const header_values[] = { onesdk_asciistr("example.com"), onesdk_asciistr("benchmark/1.0") };
+
+    onesdk_tracer_handle_t const tracer = onesdk_incomingwebrequesttracer_create(
+        g_webapplicationinfo, onesdk_asciistr("/prices/42?currency=EUR"), onesdk_asciistr("GET"));
+    onesdk_incomingwebrequesttracer_set_remote_address(tracer, onesdk_asciistr("10.0.0.1:54321"));
+    onesdk_incomingwebrequesttracer_add_request_headers_p(tracer, header_names, header_values, 2);
+    onesdk_tracer_start(tracer);
+    onesdk_incomingwebrequesttracer_set_status_code(tracer, 200);
+    onesdk_tracer_end(tracer);
+}
+
+void run_outgoing_web_request(unsigned long long) {
+    onesdk_tracer_handle_t const tracer = onesdk_outgoingwebrequesttracer_create(
+        onesdk_asciistr("http://example.com/prices/42"), onesdk_asciistr("GET"));
+    onesdk_tracer_start(tracer);
+    char tag[ONESDK_DYNATRACE_STRING_TAG_BUFFER_SIZE];
+    onesdk_tracer_get_outgoing_dynatrace_string_tag(tracer, tag, sizeof(tag), NULL);
+    onesdk_outgoingwebrequesttracer_add_request_header(tracer, onesdk_asciistr(ONESDK_DYNATRACE_HTTP_HEADER_NAME), onesdk_asciistr(tag));
+    onesdk_outgoingwebrequesttracer_set_status_code(tracer, 200);
+    onesdk_tracer_end(tracer);
+}
+
+void run_outgoing_message(unsigned long long) {
+    onesdk_tracer_handle_t const tracer = onesdk_outgoingmessagetracer_create(g_messagingsysteminfo);
+    onesdk_tracer_start(tracer);
+    char tag[ONESDK_DYNATRACE_STRING_TAG_BUFFER_SIZE];
+    onesdk_tracer_get_outgoing_dynatrace_string_tag(tracer, tag, sizeof(tag), NULL);
+    onesdk_outgoingmessagetracer_set_vendor_message_id(tracer, onesdk_asciistr("msg-42"));
+    onesdk_tracer_end(tracer);
+}
+
+void run_incoming_message(unsigned long long) {
+    onesdk_tracer_handle_t const receive_tracer = onesdk_incomingmessagereceivetracer_create(g_messagingsysteminfo);
+    onesdk_tracer_start(receive_tracer);
+    onesdk_tracer_handle_t const process_tracer = onesdk_incomingmessageprocesstracer_create(g_messagingsysteminfo);
+    onesdk_tracer_set_incoming_dynatrace_string_tag(process_tracer, onesdk_asciistr(g_incoming_tag));
+    onesdk_incomingmessageprocesstracer_set_vendor_message_id(process_tracer, onesdk_asciistr("msg-42"));
+    onesdk_tracer_start(process_tracer);
+    onesdk_tracer_end(process_tracer);
+    onesdk_tracer_end(receive_tracer);
+}
+
+void run_custom_service(unsigned long long i) {
+    onesdk_tracer_handle_t const tracer = onesdk_customservicetracer_create(
+        onesdk_asciistr("benchmark_method"), onesdk_asciistr("BenchmarkService"));
+    try {
+        onesdk_tracer_start(tracer);
+        do_work(i);
+    } catch (std::exception const& e) {
+        onesdk_tracer_error(tracer, onesdk_asciistr("std::exception"), onesdk_asciistr(e.what()));
+    } catch (...) {
+        onesdk_tracer_error(tracer, onesdk_asciistr("unknown exception"), onesdk_asciistr("unknown error"));
+    }
+    onesdk_tracer_end(tracer);
+}
+
+void run_custom_service_guard(unsigned long long i) {
+    onesdk::custom_service_tracer tracer(onesdk_asciistr("benchmark_method"), onesdk_asciistr("BenchmarkService"));
+    try {
+        tracer.start();
+        do_work(i);
+    } catch (...) {
+        tracer.error_from_current_exception();
+    }
+}
+
+void run_in_process_link(unsigned long long) {
+    unsigned char link[ONESDK_IN_PROCESS_LINK_BUFFER_SIZE];
+    onesdk_size_t const link_size = onesdk_inprocesslink_create(link, sizeof(link), NULL);
+    onesdk_tracer_handle_t const tracer = onesdk_inprocesslinktracer_create(link, link_size);
+    onesdk_tracer_start(tracer);
+    onesdk_tracer_end(tracer);
+}
+
+void run_in_process_link_guard(unsigned long long) {
+    onesdk::in_process_link const link = onesdk::in_process_link::current();
+    onesdk::in_process_link_tracer tracer(link);
+    tracer.start();
+}
+
+thread_local unsigned long long t_task_sum = 0; // Keeps the tasks from being optimized away.
+
+void run_task_function(unsigned long long i) {
+    std::function<void()> const task([i] { t_task_sum += i; });
+    task();
+}
+
+void run_linked_task_function(unsigned long long i) {
+    std::function<void()> const task(onesdk::link_task([i] { t_task_sum += i; }));
+    task();
+}
+
+void run_custom_request_attributes(unsigned long long i) {
+    onesdk_customrequestattribute_add_integer(onesdk_asciistr("iteration"), static_cast<onesdk_int64_t>(i));
+    onesdk_customrequestattribute_add_string(onesdk_asciistr("customer"), onesdk_asciistr("ACME"));
+}
+
+void run_trace_context(unsigned long long) {
+    char trace_id[ONESDK_TRACE_ID_BUFFER_SIZE];
+    char span_id[ONESDK_SPAN_ID_BUFFER_SIZE];
+    onesdk_tracecontext_get_current(trace_id, sizeof(trace_id), span_id, sizeof(span_id));
+}
+
+struct family {
+    char const* name;
+    bool needs_active_tracer; // Run the loop while a custom service tracer is active on the thread.
+    void (*run)(unsigned long long i);
+};
+
+family const families[] = {
+    { "outgoing_remote_call", false, run_outgoing_remote_call },
+    { "incoming_remote_call", false, run_incoming_remote_call },
+    { "database_request", false, run_database_request },
+    { "incoming_web_request", false, run_incoming_web_request },
+    { "outgoing_web_request", false, run_outgoing_web_request },
+    { "outgoing_message", false, run_outgoing_message },
+    { "incoming_message", false, run_incoming_message },
+    { "custom_service", false, run_custom_service },
+    { "custom_service_guard", false, run_custom_service_guard },
+    { "in_process_link", true, run_in_process_link },
+    { "in_process_link_guard", true, run_in_process_link_guard },
+    { "task_function", true, run_task_function },
+    { "linked_task_function", true, run_linked_task_function },
+    { "custom_request_attributes", true, run_custom_request_attributes },
+    { "trace_context", true, run_trace_context },
+};
+
+/*----------------------------------------------------------------------------------------------------------------------------------------*/
+// Measurement
+
+struct options {
+    unsigned long long iterations = default_iterations;
+    std::string mode = "all";
+    std::vector<unsigned> thread_counts;
+    std::string family;
+};
+
+struct result {
+    double ns_per_op = 0;           // Average over all threads.
+    double allocations_per_op = 0;  // Average over all threads.
+    double mops_per_second = 0;     // Total over all threads.
+};
+
+result measure_once(family const& f, unsigned thread_count, unsigned long long iterations) {
+    std::vector<double> ns(thread_count);
+    std::vector<unsigned long long> allocations(thread_count);
+    std::atomic<unsigned> ready(0);
+    std::atomic<bool> go(false);
+    std::atomic<long long> first_start(0);
+    std::atomic<long long> last_end(0);
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < thread_count; t++) {
+        threads.emplace_back([&, t]() {
+            onesdk_tracer_handle_t active_tracer = ONESDK_INVALID_HANDLE;
+            if (f.needs_active_tracer) {
+                active_tracer = onesdk_customservicetracer_create(onesdk_asciistr("benchmark_thread"), onesdk_asciistr("BenchmarkService"));
+                onesdk_tracer_start(active_tracer);
+            }
+
+            ready++;
+            while (!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+
+            unsigned long long const allocations_before = t_allocations;
+            clock_type::time_point const start_time = clock_type::now();
+            for (unsigned long long i = 0; i < iterations; i++)
+                f.run(i);
+            clock_type::time_point const end_time = clock_type::now();
+            allocations[t] = t_allocations - allocations_before;
+            ns[t] = std::chrono::duration<double, std::nano>(end_time - start_time).count();
+
+            long long const start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(start_time.time_since_epoch()).count();
+            long long const end_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time.time_since_epoch()).count();
+            long long expected = 0;
+            while (!first_start.compare_exchange_weak(expected, start_ns) && expected > start_ns) {}
+            expected = last_end.load();
+            while (expected < end_ns && !last_end.compare_exchange_weak(expected, end_ns)) {}
+
+            onesdk_tracer_end(active_tracer);
+        });
+    }
+    while (ready.load() != thread_count)
+        std::this_thread::yield();
+    go.store(true, std::memory_order_release);
+    for (std::thread& thread : threads)
+        thread.join();
+
+    result r;
+    for (unsigned t = 0; t < thread_count; t++) {
+        r.ns_per_op += ns[t] / static_cast<double>(iterations);
+        r.allocations_per_op += static_cast<double>(allocations[t]) / static_cast<double>(iterations);
+    }
+    r.ns_per_op /= thread_count;
+    r.allocations_per_op /= thread_count;
+    double const wall_ns = static_cast<double>(last_end.load() - first_start.load());
+    r.mops_per_second = wall_ns > 0 ? static_cast<double>(iterations) * thread_count * 1000.0 / wall_ns : 0;
+    return r;
+}
+
+// Keeps the best of several rounds, so that CPU frequency changes and other noise have less influence.
+result measure(family const& f, unsigned thread_count, unsigned long long iterations) {
+    result best;
+    for (unsigned round = 0; round < rounds; round++) {
+        result const r = measure_once(f, thread_count, iterations);
+        if (round == 0 || r.ns_per_op < best.ns_per_op)
+            best = r;
+    }
+    return best;
+}
+
+void create_shared_objects() {
+    g_databaseinfo = onesdk_databaseinfo_create(onesdk_asciistr("prices"), onesdk_asciistr(ONESDK_DATABASE_VENDOR_POSTGRESQL),
+        ONESDK_CHANNEL_TYPE_TCP_IP, onesdk_asciistr("db-server:5432"));
+    g_webapplicationinfo = onesdk_webapplicationinfo_create(onesdk_asciistr("benchmark.example.com"), onesdk_asciistr("PriceApp"),
+        onesdk_asciistr("/prices"));
+    g_messagingsysteminfo = onesdk_messagingsysteminfo_create(onesdk_asciistr(ONESDK_MESSAGING_VENDOR_RABBIT_MQ),
+        onesdk_asciistr("price-updates"), ONESDK_MESSAGING_DESTINATION_TYPE_TOPIC, ONESDK_CHANNEL_TYPE_TCP_IP,
+        onesdk_asciistr("kafka:9092"));
+
+    // A tag from a real tracer, so that incoming tracers are linked like in a distributed trace.
+    onesdk_tracer_handle_t const tracer = onesdk_outgoingremotecalltracer_create(onesdk_asciistr("get_price"),
+        onesdk_asciistr("PriceService"), onesdk_asciistr("price-service"), ONESDK_CHANNEL_TYPE_TCP_IP, onesdk_asciistr("price-service:8080"));
+    onesdk_tracer_start(tracer);
+    g_incoming_tag[0] = '\0';
+    onesdk_tracer_get_outgoing_dynatrace_string_tag(tracer, g_incoming_tag, sizeof(g_incoming_tag), NULL);
+    onesdk_tracer_end(tracer);
+}
+
+void delete_shared_objects() {
+    onesdk_databaseinfo_delete(g_databaseinfo);
+    onesdk_webapplicationinfo_delete(g_webapplicationinfo);
+    onesdk_messagingsysteminfo_delete(g_messagingsysteminfo);
+    g_databaseinfo = g_webapplicationinfo = g_messagingsysteminfo = ONESDK_INVALID_HANDLE;
+}
+
+void run_suite(char const* mode_name, options const& opts) {
+    create_shared_objects();
+
+    // The C++ guards skip creating tracers if the cached agent state is not active.
+    printf("\nmode: %s (agent state %d)\n", mode_name, static_cast<int>(onesdk::refresh_agent_state()));
+    printf("%-28s %8s %12s %12s %12s\n", "family", "threads", "ns/op", "allocs/op", "Mops/s");
+    for (family const& f : families) {
+        if (!opts.family.empty() && opts.family != f.name)
+            continue;
+        for (unsigned const thread_count : opts.thread_counts) {
+            result const r = measure(f, thread_count, opts.iterations);
+            printf("%-28s %8u %12.2f %12.2f %12.3f\n", f.name, thread_count, r.ns_per_op, r.allocations_per_op, r.mops_per_second);
+            fflush(stdout);
+        }
+    }
+
+    delete_shared_objects();
+}
+
+/*----------------------------------------------------------------------------------------------------------------------------------------*/
+
+std::vector<unsigned> default_thread_counts() {
+    unsigned const hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for (unsigned count = 1; count < hardware_threads; count *= 2)
+        counts.push_back(count);
+    counts.push_back(hardware_threads);
+    return counts;
+}
+
+std::vector<unsigned> parse_thread_counts(char const* list) {
+    std::vector<unsigned> counts;
+    while (*list) {
+        char* end = NULL;
+        unsigned long const count = strtoul(list, &end, 10);
+        if (end == list)
+            break;
+        if (count > 0)
+            counts.push_back(static_cast<unsigned>(count));
+        list = (*end == ',') ? end + 1 : end;
+    }
+    return counts;
+}
+
+bool parse_options(int argc, char** argv, options& opts) {
+    for (int i = 1; i < argc; i++) {
+        char const* const arg = argv[i];
+        if (strncmp(arg, "--mode=", 7) == 0) {
+            opts.mode = arg + 7;
+        } else if (strncmp(arg, "--threads=", 10) == 0) {
+            opts.thread_counts = parse_thread_counts(arg + 10);
+        } else if (strncmp(arg, "--family=", 9) == 0) {
+            opts.family = arg + 9;
+        } else if (arg[0] != '-') {
+            opts.iterations = strtoull(arg, NULL, 10);
+        } else {
+            fprintf(stderr, "unknown option '%s'\n", arg);
+            return false;
+        }
+    }
+    if (opts.iterations == 0)
+        opts.iterations = default_iterations;
+    if (opts.thread_counts.empty())
+        opts.thread_counts = default_thread_counts();
+    if (opts.mode != "all" && opts.mode != "inactive" && opts.mode != "active" && opts.mode != "forkable") {
+        fprintf(stderr, "unknown mode '%s'\n", opts.mode.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+/*========================================================================================================================================*/
+
+int main(int argc, char** argv) {
+    onesdk_stub_process_cmdline_args(argc, argv, 1);
+    onesdk_stub_strip_sdk_cmdline_args(&argc, argv);
+
+#if defined(BENCHMARK_STANDIN_AGENT)
+    // Use the stand-in agent unless an agent library was set explicitly (--dt_agentlibrary or DT_AGENTLIBRARY).
+    if (getenv("DT_AGENTLIBRARY") == NULL)
+        onesdk_stub_set_variable("agentlibrary=" BENCHMARK_STANDIN_AGENT, 0);
+#endif
+
+    options opts;
+    if (!parse_options(argc, argv, opts))
+        return 1;
+    printf("Iterations per thread: %llu\n", opts.iterations);
+
+    if (opts.mode == "all" || opts.mode == "inactive")
+        run_suite("inactive", opts);
+
+    if (opts.mode == "all" || opts.mode == "active") {
+        onesdk_result_t const result = onesdk_initialize();
+        if (result == ONESDK_SUCCESS) {
+            run_suite("active", opts);
+            onesdk_shutdown();
+        } else {
+            printf("\nmode: active skipped, SDK initialization failed (%#x)\n", static_cast<unsigned>(result));
+        }
+    }
+
+#if !defined(_WIN32)
+    if (opts.mode == "all" || opts.mode == "forkable") {
+        onesdk_result_t const result = onesdk_initialize_2(ONESDK_INIT_FLAG_FORKABLE);
+        if (result == ONESDK_SUCCESS) {
+            fflush(stdout);
+            pid_t const child = fork();
+            if (child == 0) {
+                run_suite("forkable (child process)", opts);
+                onesdk_shutdown();
+                fflush(stdout);
+                _exit(0);
+            }
+            if (child > 0)
+                waitpid(child, NULL, 0);
+            onesdk_shutdown();
+        } else {
+            printf("\nmode: forkable skipped, SDK initialization failed (%#x)\n", static_cast<unsigned>(result));
+        }
+    }
+#endif
+
+    return 0;
+}
+
+/*========================================================================================================================================*/
@@ -61,15 +61,17 @@ public:
 
             // Get the string representation of the outgoing tag from our tracer.
             // (Must be done after starting the tracer, otherwise the returned tag would be empty.)
-            std::string tag;
-            {
-                // Call once to get required buffer size (including space for the terminating NULL character).
-                onesdk_size_t required_buffer_size = 0;
-                onesdk_tracer_get_outgoing_dynatrace_string_tag(tracer, nullptr, 0, &required_buffer_size);
-                // Call again to fetch data.
+            // Try a stack buffer of the recommended size first, a single call is sufficient if the tag fits.
+            char tag_buffer[ONESDK_DYNATRACE_STRING_TAG_BUFFER_SIZE];
+            onesdk_size_t required_buffer_size = 0;
+            // The return value does NOT include the terminating NULL character.
+            onesdk_size_t tag_size = onesdk_tracer_get_outgoing_dynatrace_string_tag(tracer, tag_buffer, sizeof(tag_buffer), &required_buffer_size);
+            std::string tag(tag_buffer, tag_size);
+            if (required_buffer_size > sizeof(tag_buffer)) {
+                // No buffer size is guaranteed to be sufficient. Call again with a buffer of the required size (including space for the
+                // terminating NULL character) and use the return value to resize the string.
                 tag.resize(required_buffer_size);
-                onesdk_size_t const tag_size = onesdk_tracer_get_outgoing_dynatrace_string_tag(tracer, &tag[0], tag.size(), nullptr);
-                // Use return value to resize string (the return value does NOT include the terminating NULL character).
+                tag_size = onesdk_tracer_get_outgoing_dynatrace_string_tag(tracer, &tag[0], tag.size(), nullptr);
                 tag.resize(tag_size);
             }
 
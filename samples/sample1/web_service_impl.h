@@ -42,24 +42,25 @@ public:
 		// Note that, just like when creating new tracers, we don't need a parent tracer handle for this. The retrieved link will
 		// automatically connect to the innermost active tracer of the current thread.
 		// (Or, if there is no active tracer on the current thread, we'll get an empty link.)
-        std::vector<unsigned char> in_process_link;
-        {
-			onesdk_size_t required_buffer_size = 0;
-            // Call once to get required buffer size.
-            onesdk_inprocesslink_create(nullptr, 0, &required_buffer_size);
-            // Call again to fetch data.
-            in_process_link.resize(required_buffer_size);
-            onesdk_size_t const link_size = onesdk_inprocesslink_create(in_process_link.data(), in_process_link.size(), nullptr);
-            // Use return value to resize vector.
-            in_process_link.resize(link_size);
+        // Try a buffer of the recommended size first, a single call is sufficient if the link fits.
+        unsigned char link_buffer[ONESDK_IN_PROCESS_LINK_BUFFER_SIZE];
+        onesdk_size_t required_buffer_size = 0;
+        onesdk_size_t link_size = onesdk_inprocesslink_create(link_buffer, sizeof(link_buffer), &required_buffer_size);
+        std::vector<unsigned char> large_link;
+        if (required_buffer_size > sizeof(link_buffer)) {
+            // No buffer size is guaranteed to be sufficient. Call again with a buffer of the required size.
+            large_link.resize(required_buffer_size);
+            link_size = onesdk_inprocesslink_create(large_link.data(), large_link.size(), nullptr);
         }
 
-        // Start database request in another thread.
-        std::future<std::string> output_prefix_future = std::async(std::launch::async, [this, in_process_link]() -> std::string {
+        // Start database request in another thread. The lambda captures a copy of the link.
+        std::future<std::string> output_prefix_future = std::async(std::launch::async,
+            [this, link_buffer, large_link, link_size]() -> std::string {
             std::string result;
 
             // Create in-process link tracer so we can continue tracing in this thread.
-            onesdk_tracer_handle_t const tracer = onesdk_inprocesslinktracer_create(in_process_link.data(), in_process_link.size());
+            unsigned char const* const in_process_link = large_link.empty() ? link_buffer : large_link.data();
+            onesdk_tracer_handle_t const tracer = onesdk_inprocesslinktracer_create(in_process_link, link_size);
 
             try {
                 // Start tracer ("activates" the in-process link).
@@ -0,0 +1,1661 @@
+/*
+    Copyright 2017-2019 Dynatrace LLC
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+// Stand-in agent module, see standin_agent.h.
+//
+// The SDK stub loads an agent module with dlopen and talks to it through three exported functions (sdkagent_abi_initialize,
+// sdkagent_abi_get_library and sdkagent_abi_shutdown) and the function tables returned by sdkagent_abi_get_library. The table layouts
+// below must match the stub exactly, entries are never reordered or removed.
+//
+// All state is protected by a single mutex. Handles are slot indices tagged with a generation (see agent::add), so that looking up a
+// handle is a bounds check and a compare, and stale handles (used after the object was ended or deleted) are detected instead of
+// aliasing a newer object.
+//
+// Tracer objects, their attribute strings and the stored records are recycled, so that once every thread's tracer pool and the record
+// store are warmed up, the tracer functions don't allocate memory (see standin_agent.h).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "onesdk/onesdk_common.h"
+#include "onesdk/onesdk_string.h"
+
+#include "standin_agent.h"
+
+/*========================================================================================================================================*/
+
+namespace {
+
+struct agent;
+
+// ABI version the stub passes to get_agent.
+struct stub_version {
+    onesdk_uint32_t version_major;
+    onesdk_uint32_t version_minor;
+    onesdk_uint32_t version_patch;
+    onesdk_uint32_t version_build;
+    onesdk_uint32_t reserved[4];
+    char build_timestamp[32];
+    char reserved_2[32];
+};
+
+onesdk_uint32_t const library_id_agent = 0x25b071;
+onesdk_uint32_t const library_version_agent = 6;
+onesdk_uint32_t const library_id_metrics = 0x576ed01;
+onesdk_uint32_t const library_id_tracer_ext = 0x57602a3;
+
+typedef onesdk_string_t const* str;
+
+struct agent_functions {
+    void (ONESDK_CALL* agent_add_ref)(agent*);
+    void (ONESDK_CALL* agent_release)(agent*);
+    onesdk_bool_t (ONESDK_CALL* internal_dispatch)(agent*, onesdk_int32_t, onesdk_int32_t, void*, onesdk_size_t);
+    onesdk_int32_t (ONESDK_CALL* agent_get_current_state)(agent*);
+    void (ONESDK_CALL* agent_set_logging_callback)(agent*, onesdk_agent_logging_callback_t*);
+    void (ONESDK_CALL* tracer_start)(agent*, onesdk_tracer_handle_t);
+    void (ONESDK_CALL* tracer_end)(agent*, onesdk_tracer_handle_t);
+    void (ONESDK_CALL* tracer_error_p)(agent*, onesdk_tracer_handle_t, str, str);
+    onesdk_size_t (ONESDK_CALL* tracer_get_outgoing_dynatrace_string_tag)(agent*, onesdk_tracer_handle_t, char*, onesdk_size_t, onesdk_size_t*);
+    onesdk_size_t (ONESDK_CALL* tracer_get_outgoing_dynatrace_byte_tag)(agent*, onesdk_tracer_handle_t, unsigned char*, onesdk_size_t,
+        onesdk_size_t*);
+    void (ONESDK_CALL* tracer_set_incoming_dynatrace_string_tag_p)(agent*, onesdk_tracer_handle_t, str);
+    void (ONESDK_CALL* tracer_set_incoming_dynatrace_byte_tag)(agent*, onesdk_tracer_handle_t, unsigned char const*, onesdk_size_t);
+    onesdk_tracer_handle_t (ONESDK_CALL* outgoingremotecalltracer_create_p)(agent*, str, str, str, onesdk_int32_t, str);
+    void (ONESDK_CALL* outgoingremotecalltracer_set_protocol_name_p)(agent*, onesdk_tracer_handle_t, str);
+    onesdk_tracer_handle_t (ONESDK_CALL* incomingremotecalltracer_create_p)(agent*, str, str, str);
+    void (ONESDK_CALL* incomingremotecalltracer_set_protocol_name_p)(agent*, onesdk_tracer_handle_t, str);
+    onesdk_databaseinfo_handle_t (ONESDK_CALL* databaseinfo_create_p)(agent*, str, str, onesdk_int32_t, str);
+    void (ONESDK_CALL* databaseinfo_delete)(agent*, onesdk_databaseinfo_handle_t);
+    onesdk_tracer_handle_t (ONESDK_CALL* databaserequesttracer_create_sql_p)(agent*, onesdk_databaseinfo_handle_t, str);
+    void (ONESDK_CALL* databaserequesttracer_set_returned_row_count)(agent*, onesdk_tracer_handle_t, onesdk_int32_t);
+    void (ONESDK_CALL* databaserequesttracer_set_round_trip_count)(agent*, onesdk_tracer_handle_t, onesdk_int32_t);
+    onesdk_webapplicationinfo_handle_t (ONESDK_CALL* webapplicationinfo_create_p)(agent*, str, str, str);
+    void (ONESDK_CALL* webapplicationinfo_delete)(agent*, onesdk_webapplicationinfo_handle_t);
+    onesdk_tracer_handle_t (ONESDK_CALL* incomingwebrequesttracer_create_p)(agent*, onesdk_webapplicationinfo_handle_t, str, str);
+    void (ONESDK_CALL* incomingwebrequesttracer_set_remote_address_p)(agent*, onesdk_tracer_handle_t, str);
+    void (ONESDK_CALL* incomingwebrequesttracer_add_request_headers_p)(agent*, onesdk_tracer_handle_t, str, str, onesdk_size_t);
+    void (ONESDK_CALL* incomingwebrequesttracer_add_parameters_p)(agent*, onesdk_tracer_handle_t, str, str, onesdk_size_t);
+    void (ONESDK_CALL* incomingwebrequesttracer_add_response_headers_p)(agent*, onesdk_tracer_handle_t, str, str, onesdk_size_t);
+    void (ONESDK_CALL* incomingwebrequesttracer_set_status_code)(agent*, onesdk_tracer_handle_t, onesdk_int32_t);
+    void (ONESDK_CALL* customrequestattribute_add_integers_p)(agent*, str, onesdk_int64_t const*, onesdk_size_t);
+    void (ONESDK_CALL* customrequestattribute_add_floats_p)(agent*, str, double const*, onesdk_size_t);
+    void (ONESDK_CALL* customrequestattribute_add_strings_p)(agent*, str, str, onesdk_size_t);
+    onesdk_size_t (ONESDK_CALL* inprocesslink_create)(agent*, unsigned char*, onesdk_size_t, onesdk_size_t*);
+    onesdk_tracer_handle_t (ONESDK_CALL* inprocesslinktracer_create)(agent*, unsigned char const*, onesdk_size_t);
+    onesdk_tracer_handle_t (ONESDK_CALL* outgoingwebrequesttracer_create_p)(agent*, str, str);
+    void (ONESDK_CALL* outgoingwebrequesttracer_add_request_headers_p)(agent*, onesdk_tracer_handle_t, str, str, onesdk_size_t);
+    void (ONESDK_CALL* outgoingwebrequesttracer_add_response_headers_p)(agent*, onesdk_tracer_handle_t, str, str, onesdk_size_t);
+    void (ONESDK_CALL* outgoingwebrequesttracer_set_status_code)(agent*, onesdk_tracer_handle_t, onesdk_int32_t);
+    onesdk_tracer_handle_t (ONESDK_CALL* customservicetracer_create_p)(agent*, str, str);
+    onesdk_messagingsysteminfo_handle_t (ONESDK_CALL* messagingsysteminfo_create_p)(agent*, str, str, onesdk_int32_t, onesdk_int32_t, str);
+    void (ONESDK_CALL* messagingsysteminfo_delete)(agent*, onesdk_messagingsysteminfo_handle_t);
+    onesdk_tracer_handle_t (ONESDK_CALL* outgoingmessagetracer_create)(agent*, onesdk_messagingsysteminfo_handle_t);
+    void (ONESDK_CALL* outgoingmessagetracer_set_vendor_message_id_p)(agent*, onesdk_tracer_handle_t, str);
+    void (ONESDK_CALL* outgoingmessagetracer_set_correlation_id_p)(agent*, onesdk_tracer_handle_t, str);
+    onesdk_tracer_handle_t (ONESDK_CALL* incomingmessagereceivetracer_create)(agent*, onesdk_messagingsysteminfo_handle_t);
+    onesdk_tracer_handle_t (ONESDK_CALL* incomingmessageprocesstracer_create)(agent*, onesdk_messagingsysteminfo_handle_t);
+    void (ONESDK_CALL* incomingmessageprocesstracer_set_vendor_message_id_p)(agent*, onesdk_tracer_handle_t, str);
+    void (ONESDK_CALL* incomingmessageprocesstracer_set_correlation_id_p)(agent*, onesdk_tracer_handle_t, str);
+    onesdk_int32_t (ONESDK_CALL* agent_get_fork_state)(agent*);
+    onesdk_result_t (ONESDK_CALL* agent_set_warning_callback)(agent*, onesdk_agent_logging_callback_t*);
+    onesdk_result_t (ONESDK_CALL* agent_set_verbose_callback)(agent*, onesdk_agent_logging_callback_t*);
+    onesdk_result_t (ONESDK_CALL* tracecontext_get_current)(agent*, char*, onesdk_size_t, char*, onesdk_size_t);
+};
+
+struct library_functions {
+    onesdk_xchar_t const* (ONESDK_CALL* get_agent_version_string)(void);
+    onesdk_result_t (ONESDK_CALL* get_agent)(stub_version const*, agent**, agent_functions const**, onesdk_xchar_t*, onesdk_size_t);
+};
+
+struct metrics_functions {
+    void (ONESDK_CALL* metric_delete)(agent*, onesdk_metric_handle_t);
+    onesdk_metric_handle_t (ONESDK_CALL* integercountermetric_create)(agent*, str, str, str);
+    onesdk_metric_handle_t (ONESDK_CALL* floatcountermetric_create)(agent*, str, str, str);
+    onesdk_metric_handle_t (ONESDK_CALL* integergaugemetric_create)(agent*, str, str, str);
+    onesdk_metric_handle_t (ONESDK_CALL* floatgaugemetric_create)(agent*, str, str, str);
+    onesdk_metric_handle_t (ONESDK_CALL* integerstatisticsmetric_create)(agent*, str, str, str);
+    onesdk_metric_handle_t (ONESDK_CALL* floatstatisticsmetric_create)(agent*, str, str, str);
+    void (ONESDK_CALL* integercountermetric_increase_by)(agent*, onesdk_metric_handle_t, onesdk_int64_t, str);
+    void (ONESDK_CALL* floatcountermetric_increase_by)(agent*, onesdk_metric_handle_t, double, str);
+    void (ONESDK_CALL* integergaugemetric_set_value)(agent*, onesdk_metric_handle_t, onesdk_int64_t, str);
+    void (ONESDK_CALL* floatgaugemetric_set_value)(agent*, onesdk_metric_handle_t, double, str);
+    void (ONESDK_CALL* integerstatisticsmetric_add_value)(agent*, onesdk_metric_handle_t, onesdk_int64_t, str);
+    void (ONESDK_CALL* floatstatisticsmetric_add_value)(agent*, onesdk_metric_handle_t, double, str);
+};
+
+struct tracer_ext_functions {
+    onesdk_bool_t (ONESDK_CALL* tracer_start_2)(agent*, onesdk_tracer_handle_t, onesdk_tracer_handle_t, onesdk_int64_t);
+    void (ONESDK_CALL* tracer_end_timed)(agent*, onesdk_tracer_handle_t, onesdk_int64_t);
+};
+
+/*========================================================================================================================================*/
+
+void append_utf8(std::string& out, unsigned long code_point) {
+    if (code_point < 0x80) {
+        out += static_cast<char>(code_point);
+    } else if (code_point < 0x800) {
+        out += static_cast<char>(0xC0 | (code_point >> 6));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x10000) {
+        out += static_cast<char>(0xE0 | (code_point >> 12));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code_point >> 18));
+        out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+}
+
+// Appends Latin-1 text to out, converted to UTF-8.
+void append_latin1(std::string& out, unsigned char const* data, onesdk_size_t length) {
+    out.reserve(out.size() + length);
+    for (onesdk_size_t i = 0; i < length; i++)
+        append_utf8(out, data[i]);
+}
+
+// Appends UTF-16 text to out, converted to UTF-8.
+void append_utf16(std::string& out, unsigned char const* data, onesdk_size_t byte_length, bool big_endian) {
+    onesdk_size_t const length = byte_length / 2;
+    out.reserve(out.size() + length);
+    for (onesdk_size_t i = 0; i < length; i++) {
+        unsigned char const* const unit_bytes = data + 2 * i;
+        unsigned long const unit = big_endian ? ((unit_bytes[0] << 8) | unit_bytes[1]) : ((unit_bytes[1] << 8) | unit_bytes[0]);
+        if (unit >= 0xD800 && unit < 0xDC00 && i + 1 < length) {
+            unsigned char const* const next_bytes = unit_bytes + 2;
+            unsigned long const next = big_endian ? ((next_bytes[0] << 8) | next_bytes[1]) : ((next_bytes[1] << 8) | next_bytes[0]);
+            if (next >= 0xDC00 && next < 0xE000) {
+                append_utf8(out, 0x10000 + ((unit - 0xD800) << 10) + (next - 0xDC00));
+                i++;
+                continue;
+            }
+        }
+        append_utf8(out, (unit >= 0xD800 && unit < 0xE000) ? 0xFFFD : unit); // Unpaired surrogates become U+FFFD.
+    }
+}
+
+// Appends s to out, converting Latin-1 and UTF-16 to UTF-8 in place, so that no temporary copy is needed.
+void append_string(std::string& out, str s) {
+    if (s == nullptr || s->ccsid == ONESDK_CCSID_NULL || s->data == nullptr)
+        return;
+    unsigned char const* const data = static_cast<unsigned char const*>(s->data);
+    switch (s->ccsid) {
+    case ONESDK_CCSID_ISO8859_1:
+        append_latin1(out, data, s->byte_length);
+        break;
+    case ONESDK_CCSID_UTF16_BE:
+    case ONESDK_CCSID_UTF16_LE:
+        append_utf16(out, data, s->byte_length, s->ccsid == ONESDK_CCSID_UTF16_BE);
+        break;
+    default:
+        out.append(static_cast<char const*>(s->data), s->byte_length);
+        break;
+    }
+}
+
+std::string to_string(str s) {
+    std::string out;
+    append_string(out, s);
+    return out;
+}
+
+// Assigns s to out, reusing the memory of out.
+void assign_string(std::string& out, str s) {
+    out.clear();
+    append_string(out, s);
+}
+
+// A formatted number.
+struct formatted {
+    char text[32];
+};
+
+formatted format_int32(onesdk_int32_t value) {
+    formatted f;
+    snprintf(f.text, sizeof(f.text), "%d", static_cast<int>(value));
+    return f;
+}
+
+formatted format_int64(onesdk_int64_t value) {
+    formatted f;
+    snprintf(f.text, sizeof(f.text), "%lld", static_cast<long long>(value));
+    return f;
+}
+
+formatted format_double(double value) {
+    formatted f;
+    snprintf(f.text, sizeof(f.text), "%.17g", value);
+    return f;
+}
+
+// An attribute value that hasn't been copied yet: an SDK string or a formatted number (which must outlive the attribute_value).
+struct attribute_value {
+    attribute_value(str s) : string(s), text(nullptr) {}
+    attribute_value(formatted const& f) : string(nullptr), text(f.text) {}
+
+    void assign_to(std::string& out) const {
+        if (text)
+            out.assign(text);
+        else
+            assign_string(out, string);
+    }
+
+    str string;
+    char const* text;
+};
+
+struct attribute_ref {
+    char const* name;
+    attribute_value value;
+};
+
+// A list of name/value pairs. Clearing it keeps the pairs and the memory of their strings, so that refilling it doesn't allocate.
+class attribute_list {
+public:
+    typedef std::pair<std::string, std::string> attribute;
+
+    attribute const* begin() const { return m_items.data(); }
+    attribute const* end() const { return m_items.data() + m_size; }
+    std::size_t size() const { return m_size; }
+    void clear() { m_size = 0; }
+
+    // Appends a pair with unspecified contents, the caller assigns both strings.
+    attribute& add() {
+        if (m_size == m_items.size())
+            m_items.emplace_back();
+        return m_items[m_size++];
+    }
+
+    void add(char const* name, attribute_value const& value) {
+        attribute& a = add();
+        a.first.assign(name);
+        value.assign_to(a.second);
+    }
+
+    void add(std::initializer_list<attribute_ref> attributes) {
+        for (attribute_ref const& a : attributes)
+            add(a.name, a.value);
+    }
+
+    void add(attribute_list const& other) {
+        for (attribute const& o : other) {
+            attribute& a = add();
+            a.first.assign(o.first);
+            a.second.assign(o.second);
+        }
+    }
+
+private:
+    std::vector<attribute> m_items;
+    std::size_t m_size = 0;
+};
+
+onesdk_int64_t now_micros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void append_hex(std::string& out, onesdk_uint64_t value) {
+    char buffer[17];
+    snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+    out += buffer;
+}
+
+bool parse_hex(char const* text, onesdk_uint64_t& value) {
+    value = 0;
+    for (int i = 0; i < 16; i++) {
+        char const c = text[i];
+        int digit;
+        if (c >= '0' && c <= '9')
+            digit = c - '0';
+        else if (c >= 'a' && c <= 'f')
+            digit = c - 'a' + 10;
+        else
+            return false;
+        value = (value << 4) | static_cast<onesdk_uint64_t>(digit);
+    }
+    return true;
+}
+
+void append_json_string(std::string& out, std::string const& value) {
+    out += '"';
+    for (char const c : value) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buffer[8];
+                snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+                out += buffer;
+            } else {
+                out += c;
+            }
+        }
+    }
+    out += '"';
+}
+
+void append_json_attributes(std::string& out, char const* name, attribute_list const& attributes) {
+    out += ",\"";
+    out += name;
+    out += "\":[";
+    bool first = true;
+    for (attribute_list::attribute const& a : attributes) {
+        if (!first)
+            out += ',';
+        first = false;
+        out += '[';
+        append_json_string(out, a.first);
+        out += ',';
+        append_json_string(out, a.second);
+        out += ']';
+    }
+    out += ']';
+}
+
+/*========================================================================================================================================*/
+
+enum class object_kind { tracer, info, metric };
+
+struct object {
+    explicit object(object_kind k) : kind(k) {}
+    virtual ~object() {}
+    object_kind const kind;
+};
+
+// Database, web application and messaging system infos. Their attributes are copied into every tracer created from them.
+struct info : object {
+    info() : object(object_kind::info) {}
+    attribute_list attributes;
+};
+
+struct trace_position {
+    onesdk_uint64_t trace_id_high = 0;
+    onesdk_uint64_t trace_id_low = 0;
+    onesdk_uint64_t span_id = 0;
+
+    bool valid() const { return span_id != 0; }
+};
+
+struct tracer : object {
+    enum tracer_state { created, started };
+
+    explicit tracer(char const* t) : object(object_kind::tracer), type(t) {}
+
+    // Prepares a pooled tracer for reuse. The attribute lists and strings keep their memory.
+    void reset(char const* t) {
+        type = t;
+        state = created;
+        thread = 0;
+        creator_thread = 0;
+        position = trace_position();
+        parent_span_id = 0;
+        link = trace_position();
+        start_time = 0;
+        attributes.clear();
+        request_attributes.clear();
+        has_error = false;
+        error_class.clear();
+        error_message.clear();
+    }
+
+    char const* type;
+    tracer_state state = created;
+    onesdk_uint64_t thread = 0; // The thread that started the tracer.
+    onesdk_uint64_t creator_thread = 0;
+    trace_position position;
+    onesdk_uint64_t parent_span_id = 0;
+    trace_position link; // From an incoming tag or in-process link.
+    onesdk_int64_t start_time = 0;
+    attribute_list attributes;
+    attribute_list request_attributes;
+    bool has_error = false;
+    std::string error_class;
+    std::string error_message;
+};
+
+struct metric : object {
+    struct aggregate {
+        onesdk_uint64_t count = 0;
+        double sum = 0;
+        double min = 0;
+        double max = 0;
+        double last = 0;
+    };
+
+    metric(char const* t, std::string k, std::string u, std::string d)
+        : object(object_kind::metric), type(t), key(std::move(k)), unit(std::move(u)), dimension(std::move(d)) {}
+
+    char const* const type;
+    std::string const key;
+    std::string const unit;
+    std::string const dimension;
+    std::map<std::string, aggregate> values; // By dimension value.
+};
+
+// The thread-local stack of started tracers. Entries can be stale (tracer ended on another thread), lookups skip them.
+thread_local std::vector<onesdk_tracer_handle_t> t_active_tracers;
+
+// Ended tracers go to the pool of the thread that ended them and are reused by the next tracers that thread creates.
+std::size_t const max_pooled_tracers = 256;
+thread_local std::vector<std::unique_ptr<tracer>> t_tracer_pool;
+
+// The record of the tracer that is being ended, formatted without allocating once its capacity is large enough.
+thread_local std::string t_record;
+
+onesdk_uint64_t current_thread_number() {
+    static std::atomic<onesdk_uint64_t> next_number(0);
+    thread_local onesdk_uint64_t const number = ++next_number;
+    return number;
+}
+
+/*========================================================================================================================================*/
+
+struct agent {
+    std::mutex mutex;
+
+    // Configuration, set by sdkagent_abi_initialize.
+    std::string output_path;
+    std::size_t max_records = 10000;
+    onesdk_int32_t configured_state = ONESDK_AGENT_STATE_ACTIVE;
+    bool forkable = false;
+    bool check_handles = false;
+    pid_t initial_pid = 0;
+
+    pid_t pid = 0;
+    bool child_used = false;
+    FILE* output = nullptr;
+    onesdk_agent_logging_callback_t* warning_callback = nullptr;
+    onesdk_agent_logging_callback_t* verbose_callback = nullptr;
+
+    struct slot {
+        onesdk_uint32_t generation = 1;
+        std::unique_ptr<object> obj;
+        // The type of the object last removed from the slot (null if it wasn't a tracer) and the thread that removed it, for diagnostics.
+        char const* ended_type = nullptr;
+        onesdk_uint64_t ended_thread = 0;
+    };
+    std::vector<slot> slots;
+    std::vector<onesdk_uint32_t> free_slots;
+
+    onesdk_uint64_t next_span_id = 0;
+    onesdk_uint64_t next_trace_id = 0;
+    std::vector<std::string> records; // Ring buffer of record_count records starting at first_record, its strings are reused.
+    std::size_t first_record = 0;
+    std::size_t record_count = 0;
+    onesdk_standin_counters_t counters = onesdk_standin_counters_t();
+
+    /*------------------------------------------------------------------------------------------------------------------------------------*/
+    // Handles. Must be called with mutex held.
+    //
+    // A handle is (generation << 32) | (index + 1), where index is the position of the object's slot in slots. The generation of a slot is
+    // incremented when its object is removed, so handles are never zero and a handle is valid exactly while its generation matches the
+    // slot's generation. Removed slots are reused, their old handles stay invalid (until the 32 bit generation wraps around).
+
+    onesdk_handle_t add(std::unique_ptr<object> obj) {
+        onesdk_uint32_t index;
+        if (!free_slots.empty()) {
+            index = free_slots.back();
+            free_slots.pop_back();
+        } else {
+            index = static_cast<onesdk_uint32_t>(slots.size());
+            slots.push_back(slot());
+        }
+        slots[index].obj = std::move(obj);
+        return (static_cast<onesdk_handle_t>(slots[index].generation) << 32) | (index + 1);
+    }
+
+    slot* find_slot(onesdk_handle_t handle, object_kind kind) {
+        onesdk_uint64_t const index = (handle & 0xffffffffu) - 1;
+        if (handle == ONESDK_INVALID_HANDLE || index >= slots.size())
+            return nullptr;
+        slot& s = slots[static_cast<std::size_t>(index)];
+        if (s.generation != (handle >> 32) || !s.obj || s.obj->kind != kind)
+            return nullptr;
+        return &s;
+    }
+
+    template <typename Object>
+    Object* find(onesdk_handle_t handle, object_kind kind) {
+        slot* const s = find_slot(handle, kind);
+        return s ? static_cast<Object*>(s->obj.get()) : nullptr;
+    }
+
+    std::unique_ptr<object> remove(onesdk_handle_t handle, object_kind kind) {
+        slot* const s = find_slot(handle, kind);
+        if (!s)
+            return nullptr;
+        std::unique_ptr<object> obj = std::move(s->obj);
+        s->ended_type = kind == object_kind::tracer ? static_cast<tracer const&>(*obj).type : nullptr;
+        s->ended_thread = current_thread_number();
+        s->generation++;
+        free_slots.push_back(static_cast<onesdk_uint32_t>(s - slots.data()));
+        return obj;
+    }
+
+    // Describes why handle doesn't refer to a tracer, counts the misuse and, if check_handles is set, describes the handle in details.
+    char const* tracer_handle_problem(onesdk_tracer_handle_t handle, bool ending, std::string& details) {
+        onesdk_uint64_t const index = (handle & 0xffffffffu) - 1;
+        onesdk_uint64_t const generation = handle >> 32;
+        slot const* const s = index < slots.size() ? &slots[static_cast<std::size_t>(index)] : nullptr;
+
+        char const* problem;
+        if (!s || generation == 0 || generation > s->generation) {
+            problem = "unknown tracer handle";
+        } else if (generation == s->generation) {
+            problem = "handle doesn't refer to a tracer";
+        } else if (ending) {
+            problem = "tracer ended twice";
+            counters.tracers_ended_twice++;
+        } else {
+            problem = "tracer used after it was ended";
+            counters.tracers_used_after_end++;
+        }
+
+        if (check_handles) {
+            char buffer[192];
+            int length = snprintf(buffer, sizeof(buffer), "handle 0x%016llx: slot %llu, generation %llu",
+                static_cast<unsigned long long>(handle), static_cast<unsigned long long>(index),
+                static_cast<unsigned long long>(generation));
+            if (s && generation + 1 == s->generation && s->ended_type && length > 0 && static_cast<std::size_t>(length) < sizeof(buffer)) {
+                snprintf(buffer + length, sizeof(buffer) - length, ", %s tracer ended on thread %llu", s->ended_type,
+                    static_cast<unsigned long long>(s->ended_thread));
+            }
+            details = buffer;
+        }
+        return problem;
+    }
+
+    // Counts a call from a thread other than the tracer's creator and, if check_handles is set, describes the tracer in details.
+    char const* other_thread_problem(onesdk_tracer_handle_t handle, tracer const& t, char const* problem, std::string& details) {
+        counters.tracers_used_on_other_thread++;
+        if (check_handles) {
+            char buffer[192];
+            snprintf(buffer, sizeof(buffer), "handle 0x%016llx: %s tracer created on thread %llu, used on thread %llu",
+                static_cast<unsigned long long>(handle), t.type, static_cast<unsigned long long>(t.creator_thread),
+                static_cast<unsigned long long>(current_thread_number()));
+            details = buffer;
+        }
+        return problem;
+    }
+
+    /*------------------------------------------------------------------------------------------------------------------------------------*/
+    // State. Must be called with mutex held.
+
+    onesdk_int32_t current_state() {
+        if (configured_state != ONESDK_AGENT_STATE_ACTIVE)
+            return configured_state;
+        if (forkable && pid == initial_pid)
+            return ONESDK_AGENT_STATE_TEMPORARILY_INACTIVE; // Parent-initialized.
+        child_used = true;
+        return ONESDK_AGENT_STATE_ACTIVE;
+    }
+
+    tracer* current_tracer() {
+        while (!t_active_tracers.empty()) {
+            tracer* const t = find<tracer>(t_active_tracers.back(), object_kind::tracer);
+            if (t && t->state == tracer::started)
+                return t;
+            t_active_tracers.pop_back();
+        }
+        return nullptr;
+    }
+
+    void store(std::string const& record) {
+        if (output) {
+            fputs(record.c_str(), output);
+            fputc('\n', output);
+        }
+        if (max_records == 0) {
+            counters.records_discarded++;
+            return;
+        }
+        if (record_count == max_records) {
+            // Overwrite the oldest record.
+            records[first_record].assign(record);
+            first_record = (first_record + 1) % max_records;
+            counters.records_discarded++;
+            return;
+        }
+        std::size_t const index = (first_record + record_count) % max_records;
+        if (index == records.size())
+            records.push_back(record);
+        else
+            records[index].assign(record);
+        record_count++;
+    }
+
+    template <typename Function>
+    void visit_records(Function function) const {
+        for (std::size_t i = 0; i < record_count; i++)
+            function(records[(first_record + i) % max_records]);
+    }
+
+    void clear_records() {
+        first_record = 0;
+        record_count = 0;
+    }
+
+    std::string metric_record(metric const& m, std::string const& dimension_value, metric::aggregate const& a) const {
+        std::string record = "{\"record\":\"metric\",\"type\":\"";
+        record += m.type;
+        record += "\",\"key\":";
+        append_json_string(record, m.key);
+        record += ",\"unit\":";
+        append_json_string(record, m.unit);
+        record += ",\"dimension\":";
+        append_json_string(record, m.dimension);
+        record += ",\"dimension_value\":";
+        append_json_string(record, dimension_value);
+        char buffer[160];
+        snprintf(buffer, sizeof(buffer), ",\"count\":%llu,\"sum\":%.17g,\"min\":%.17g,\"max\":%.17g,\"last\":%.17g}",
+            static_cast<unsigned long long>(a.count), a.sum, a.min, a.max, a.last);
+        record += buffer;
+        return record;
+    }
+
+    template <typename Function>
+    std::size_t visit_metrics(Function function) const {
+        std::size_t count = 0;
+        for (slot const& s : slots) {
+            if (!s.obj || s.obj->kind != object_kind::metric)
+                continue;
+            metric const& m = static_cast<metric const&>(*s.obj);
+            for (auto const& value : m.values) {
+                function(metric_record(m, value.first, value.second));
+                count++;
+            }
+        }
+        return count;
+    }
+
+    void clear() {
+        clear_records();
+        for (slot& s : slots) {
+            if (s.obj && s.obj->kind == object_kind::metric)
+                static_cast<metric&>(*s.obj).values.clear();
+        }
+        counters = onesdk_standin_counters_t();
+    }
+};
+
+agent g_agent;
+
+/*========================================================================================================================================*/
+// Diagnostics. Callbacks are invoked without holding the mutex.
+
+void warn(char const* function, char const* message, std::string const& details = std::string()) {
+    onesdk_agent_logging_callback_t* callback;
+    {
+        std::lock_guard<std::mutex> lock(g_agent.mutex);
+        g_agent.counters.misuses++;
+        callback = g_agent.warning_callback;
+    }
+    if (callback) {
+        std::string text = std::string("[stand-in agent] ") + function + ": " + message;
+        if (!details.empty())
+            text += " (" + details + ")";
+        text += "\n";
+        callback(text.c_str());
+    }
+}
+
+#define STANDIN_WARN(message) warn(__func__, message)
+
+/*========================================================================================================================================*/
+// Tracers
+
+std::unique_ptr<tracer> acquire_tracer(char const* type, bool& allocated) {
+    allocated = t_tracer_pool.empty();
+    if (allocated)
+        return std::unique_ptr<tracer>(new tracer(type));
+    std::unique_ptr<tracer> t = std::move(t_tracer_pool.back());
+    t_tracer_pool.pop_back();
+    t->reset(type);
+    return t;
+}
+
+void release_tracer(std::unique_ptr<tracer> t) {
+    if (t_tracer_pool.size() < max_pooled_tracers)
+        t_tracer_pool.push_back(std::move(t));
+}
+
+onesdk_tracer_handle_t add_tracer(std::unique_ptr<tracer> t, bool allocated) {
+    std::lock_guard<std::mutex> lock(g_agent.mutex);
+    if (allocated)
+        g_agent.counters.tracers_allocated++;
+    t->creator_thread = current_thread_number();
+    if (g_agent.current_state() != ONESDK_AGENT_STATE_ACTIVE) {
+        release_tracer(std::move(t));
+        return ONESDK_INVALID_HANDLE;
+    }
+    g_agent.counters.tracers_created++;
+    return g_agent.add(std::move(t));
+}
+
+onesdk_tracer_handle_t create_tracer(char const* type, std::initializer_list<attribute_ref> attributes,
+                                     trace_position link = trace_position()) {
+    bool allocated;
+    std::unique_ptr<tracer> t = acquire_tracer(type, allocated);
+    t->attributes.add(attributes);
+    t->link = link;
+    return add_tracer(std::move(t), allocated);
+}
+
+onesdk_tracer_handle_t create_tracer_from_info(char const* type, onesdk_handle_t info_handle, std::initializer_list<attribute_ref> attributes) {
+    bool allocated;
+    std::unique_ptr<tracer> t = acquire_tracer(type, allocated);
+    {
+        std::lock_guard<std::mutex> lock(g_agent.mutex);
+        info const* const i = g_agent.find<info>(info_handle, object_kind::info);
+        if (i)
+            t->attributes.add(i->attributes);
+        else
+            info_handle = ONESDK_INVALID_HANDLE;
+    }
+    if (info_handle == ONESDK_INVALID_HANDLE) {
+        release_tracer(std::move(t));
+        STANDIN_WARN("invalid info handle");
+        return ONESDK_INVALID_HANDLE;
+    }
+    t->attributes.add(attributes);
+    return add_tracer(std::move(t), allocated);
+}
+
+// Calls function(tracer&) with the mutex held if handle refers to a tracer in one of the given states.
+template <typename Function>
+void with_tracer(char const* function_name, onesdk_tracer_handle_t handle, bool allow_created, bool allow_started, Function function) {
+    if (handle == ONESDK_INVALID_HANDLE)
+        return;
+    char const* problem = nullptr;
+    std::string details;
+    {
+        std::lock_guard<std::mutex> lock(g_agent.mutex);
+        tracer* const t = g_agent.find<tracer>(handle, object_kind::tracer);
+        if (!t) {
+            problem = g_agent.tracer_handle_problem(handle, false, details);
+        } else if (t->state == tracer::created && !allow_created) {
+            problem = "tracer not started";
+        } else if (t->state == tracer::started && !allow_started) {
+            problem = "tracer already started";
+        } else {
+            // Like tracers started on another thread, calls from other threads are only checked with standin_check_handles=1.
+            if (g_agent.check_handles && t->creator_thread != current_thread_number())
+                problem = g_agent.other_thread_problem(handle, *t, "tracer used on a different thread than it was created on", details);
+            function(*t);
+        }
+    }
+    if (problem)
+        warn(function_name, problem, details);
+}
+
+void start_tracer(char const* function_name, onesdk_tracer_handle_t handle, onesdk_tracer_handle_t parent_handle, onesdk_int64_t start_time) {
+    bool unknown_parent = false;
+    with_tracer(function_name, handle, true, false, [&](tracer& t) {
+        tracer const* parent = nullptr;
+        if (parent_handle != ONESDK_INVALID_HANDLE) {
+            parent = g_agent.find<tracer>(parent_handle, object_kind::tracer);
+            unknown_parent = parent == nullptr;
+        } else if (!t.link.valid()) {
+            parent = g_agent.current_tracer();
+        }
+
+        t.state = tracer::started;
+        t.thread = current_thread_number();
+        t.start_time = start_time ? start_time : now_micros();
+        t.position.span_id = ++g_agent.next_span_id;
+        if (parent) {
+            t.position.trace_id_high = parent->position.trace_id_high;
+            t.position.trace_id_low = parent->position.trace_id_low;
+            t.parent_span_id = parent->position.span_id;
+        } else if (t.link.valid()) {
+            t.position.trace_id_high = t.link.trace_id_high;
+            t.position.trace_id_low = t.link.trace_id_low;
+            t.parent_span_id = t.link.span_id;
+        } else {
+            t.position.trace_id_high = static_cast<onesdk_uint64_t>(g_agent.pid);
+            t.position.trace_id_low = ++g_agent.next_trace_id;
+        }
+        t_active_tracers.push_back(handle);
+    });
+    if (unknown_parent)
+        warn(function_name, "unknown or ended parent tracer, starting as root tracer");
+}
+
+void end_tracer(char const* function_name, onesdk_tracer_handle_t handle, onesdk_int64_t end_time) {
+    if (handle == ONESDK_INVALID_HANDLE)
+        return;
+    char const* problem = nullptr;
+    std::string details;
+    {
+        std::lock_guard<std::mutex> lock(g_agent.mutex);
+        std::unique_ptr<tracer> t(static_cast<tracer*>(g_agent.remove(handle, object_kind::tracer).release()));
+        if (!t) {
+            problem = g_agent.tracer_handle_problem(handle, true, details);
+        } else if (t->state != tracer::started) {
+            problem = "tracer ended without being started";
+        } else {
+            if (t->creator_thread != current_thread_number())
+                problem = g_agent.other_thread_problem(handle, *t, "tracer ended on a different thread than it was created on", details);
+
+            std::vector<onesdk_tracer_handle_t>::iterator const active =
+                std::find(t_active_tracers.begin(), t_active_tracers.end(), handle);
+            if (active != t_active_tracers.end())
+                t_active_tracers.erase(active);
+
+            g_agent.counters.tracers_ended++;
+            std::string& record = t_record;
+            record = "{\"record\":\"tracer\",\"type\":\"";
+            record += t->type;
+            record += "\",\"trace_id\":\"";
+            append_hex(record, t->position.trace_id_high);
+            append_hex(record, t->position.trace_id_low);
+            record += "\",\"span_id\":\"";
+            append_hex(record, t->position.span_id);
+            record += "\",\"parent_span_id\":\"";
+            if (t->parent_span_id)
+                append_hex(record, t->parent_span_id);
+            char buffer[96];
+            snprintf(buffer, sizeof(buffer), "\",\"thread\":%llu,\"start_time\":%lld,\"end_time\":%lld",
+                static_cast<unsigned long long>(t->thread), static_cast<long long>(t->start_time),
+                static_cast<long long>(end_time ? end_time : now_micros()));
+            record += buffer;
+            append_json_attributes(record, "attributes", t->attributes);
+            append_json_attributes(record, "request_attributes", t->request_attributes);
+            if (t->has_error) {
+                record += ",\"error_class\":";
+                append_json_string(record, t->error_class);
+                record += ",\"error_message\":";
+                append_json_string(record, t->error_message);
+            }
+            record += '}';
+
+            g_agent.store(record);
+            release_tracer(std::move(t));
+        }
+    }
+    if (problem)
+        warn(function_name, problem, details);
+}
+
+void set_attribute(char const* function_name, onesdk_tracer_handle_t handle, char const* name, attribute_value const& value) {
+    with_tracer(function_name, handle, true, true, [&](tracer& t) { t.attributes.add(name, value); });
+}
+
+void add_attributes(char const* function_name, onesdk_tracer_handle_t handle, char const* prefix, str names, str values, onesdk_size_t count) {
+    if (names == nullptr || values == nullptr)
+        count = 0;
+    with_tracer(function_name, handle, true, true, [&](tracer& t) {
+        for (onesdk_size_t i = 0; i < count; i++) {
+            attribute_list::attribute& a = t.attributes.add();
+            a.first.assign(prefix);
+            append_string(a.first, names + i);
+            assign_string(a.second, values + i);
+        }
+    });
+}
+
+// String and byte tags both use the format "FW4;standin;<32 hex digit trace id>;<16 hex digit span id>".
+char const tag_prefix[] = "FW4;standin;";
+std::size_t const tag_prefix_length = sizeof(tag_prefix) - 1;
+
+std::size_t const tag_buffer_size = 80;
+
+// Writes the tag into buffer (tag_buffer_size chars) and returns its length.
+std::size_t format_tag(char* buffer, char const* prefix, trace_position const& position) {
+    int const length = snprintf(buffer, tag_buffer_size, "%s%016llx%016llx;%016llx", prefix,
+        static_cast<unsigned long long>(position.trace_id_high), static_cast<unsigned long long>(position.trace_id_low),
+        static_cast<unsigned long long>(position.span_id));
+    return length > 0 ? static_cast<std::size_t>(length) : 0;
+}
+
+trace_position parse_tag(char const* prefix, std::size_t prefix_length, char const* tag, std::size_t tag_size) {
+    trace_position position;
+    if (tag_size != prefix_length + 32 + 1 + 16 || memcmp(tag, prefix, prefix_length) != 0 || tag[prefix_length + 32] != ';')
+        return trace_position();
+    char const* const ids = tag + prefix_length;
+    if (!parse_hex(ids, position.trace_id_high) || !parse_hex(ids + 16, position.trace_id_low) || !parse_hex(ids + 33, position.span_id))
+        return trace_position();
+    return position;
+}
+
+// Copies data into buffer following the usual SDK conventions. Returns the number of bytes copied (not including a terminator).
+onesdk_size_t copy_out(char const* data, std::size_t size, void* buffer, onesdk_size_t buffer_size, onesdk_size_t* required_buffer_size,
+                       bool terminate) {
+    onesdk_size_t const required = static_cast<onesdk_size_t>(size + (terminate ? 1 : 0));
+    if (required_buffer_size)
+        *required_buffer_size = size == 0 ? 0 : required;
+    if (buffer == nullptr || buffer_size == 0)
+        return 0;
+    if (size == 0 || buffer_size < required) {
+        if (terminate)
+            static_cast<char*>(buffer)[0] = '\0';
+        return 0;
+    }
+    memcpy(buffer, data, size);
+    if (terminate)
+        static_cast<char*>(buffer)[size] = '\0';
+    return static_cast<onesdk_size_t>(size);
+}
+
+// Writes the outgoing tag of the tracer into tag (tag_buffer_size chars) and returns its length, 0 if the tracer isn't started.
+std::size_t outgoing_tag(char const* function_name, onesdk_tracer_handle_t handle, char* tag) {
+    std::size_t size = 0;
+    with_tracer(function_name, handle, false, true, [&](tracer& t) { size = format_tag(tag, tag_prefix, t.position); });
+    return size;
+}
+
+void set_incoming_tag(char const* function_name, onesdk_tracer_handle_t handle, char const* tag, std::size_t tag_size) {
+    trace_position const position = parse_tag(tag_prefix, tag_prefix_length, tag, tag_size);
+    with_tracer(function_name, handle, true, false, [&](tracer& t) {
+        t.link = position;
+        attribute_list::attribute& a = t.attributes.add();
+        a.first.assign("incoming_tag");
+        a.second.assign(tag, tag_size);
+    });
+}
+
+template <typename Value, typename Format>
+void add_request_attributes(char const* function_name, str keys, Value const* values, onesdk_size_t count, Format format) {
+    if (keys == nullptr || values == nullptr || count == 0)
+        return;
+
+    bool added = false;
+    {
+        std::lock_guard<std::mutex> lock(g_agent.mutex);
+        tracer* const t = g_agent.current_tracer();
+        if (t) {
+            for (onesdk_size_t i = 0; i < count; i++) {
+                attribute_list::attribute& a = t->request_attributes.add();
+                assign_string(a.first, keys + i);
+                attribute_value(format(values[i])).assign_to(a.second);
+            }
+            g_agent.counters.request_attributes += count;
+            added = true;
+        }
+    }
+    if (!added)
+        warn(function_name, "no active tracer");
+}
+
+
+/*========================================================================================================================================*/
+// Infos and metrics
+
+onesdk_handle_t create_info(std::initializer_list<attribute_ref> attributes) {
+    std::unique_ptr<info> i(new info());
+    i->attributes.add(attributes);
+    std::lock_guard<std::mutex> lock(g_agent.mutex);
+    if (g_agent.current_state() != ONESDK_AGENT_STATE_ACTIVE)
+        return ONESDK_INVALID_HANDLE;
+    return g_agent.add(std::move(i));
+}
+
+void delete_object(char const* function_name, onesdk_handle_t handle, object_kind kind) {
+    if (handle == ONESDK_INVALID_HANDLE)
+        return;
+    bool found;
+    {
+        std::unique_ptr<object> obj;
+        std::lock_guard<std::mutex> lock(g_agent.mutex);
+        obj = g_agent.remove(handle, kind);
+        found = obj != nullptr;
+    }
+    if (!found)
+        warn(function_name, "unknown handle");
+}
+
+onesdk_metric_handle_t create_metric(char const* type, str key, str unit, str dimension) {
+    std::unique_ptr<metric> m(new metric(type, to_string(key), to_string(unit), to_string(dimension)));
+    std::lock_guard<std::mutex> lock(g_agent.mutex);
+    if (g_agent.current_state() != ONESDK_AGENT_STATE_ACTIVE)
+        return ONESDK_INVALID_HANDLE;
+    return g_agent.add(std::move(m));
+}
+
+void add_metric_value(char const* function_name, onesdk_metric_handle_t handle, double value, str dimension, bool is_counter) {
+    if (handle == ONESDK_INVALID_HANDLE)
+        return;
+    static thread_local std::string dimension_value;
+    assign_string(dimension_value, dimension);
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(g_agent.mutex);
+        metric* const m = g_agent.find<metric>(handle, object_kind::metric);
+        if (m) {
+            std::map<std::string, metric::aggregate>::iterator aggregate = m->values.find(dimension_value);
+            if (aggregate == m->values.end())
+                aggregate = m->values.emplace(dimension_value, metric::aggregate()).first;
+            metric::aggregate& a = aggregate->second;
+            a.min = a.count == 0 ? value : std::min(a.min, value);
+            a.max = a.count == 0 ? value : std::max(a.max, value);
+            a.count++;
+            a.sum += value;
+            a.last = is_counter ? a.sum : value;
+            g_agent.counters.metric_values++;
+            found = true;
+        }
+    }
+    if (!found)
+        warn(function_name, "unknown metric handle");
+}
+
+/*========================================================================================================================================*/
+// Agent function table
+
+void ONESDK_CALL agent_add_ref(agent*) {}
+
+void ONESDK_CALL agent_release(agent*) {}
+
+onesdk_bool_t ONESDK_CALL internal_dispatch(agent*, onesdk_int32_t, onesdk_int32_t, void*, onesdk_size_t) {
+    return 0;
+}
+
+onesdk_int32_t ONESDK_CALL agent_get_current_state(agent*) {
+    std::lock_guard<std::mutex> lock(g_agent.mutex);
+    return g_agent.current_state();
+}
+
+void ONESDK_CALL agent_set_logging_callback(agent*, onesdk_agent_logging_callback_t* callback) {
+    std::lock_guard<std::mutex> lock(g_agent.mutex);
+    g_agent.warning_callback = callback;
+}
+
+void ONESDK_CALL tracer_start(agent*, onesdk_tracer_handle_t handle) {
+    start_tracer(__func__, handle, ONESDK_INVALID_HANDLE, 0);
+}
+
+void ONESDK_CALL tracer_end(agent*, onesdk_tracer_handle_t handle) {
+    end_tracer(__func__, handle, 0);
+}
+
+void ONESDK_CALL tracer_error_p(agent*, onesdk_tracer_handle_t handle, str error_class, str error_message) {
+    with_tracer(__func__, handle, false, true, [&](tracer& t) {
+        t.has_error = true;
+        assign_string(t.error_class, error_class);
+        assign_string(t.error_message, error_message);
+    });
+}
+
+onesdk_size_t ONESDK_CALL tracer_get_outgoing_dynatrace_string_tag(agent*, onesdk_tracer_handle_t handle, char* buffer,
+                                                                   onesdk_size_t buffer_size, onesdk_size_t* required_buffer_size) {
+    char tag[tag_buffer_size];
+    return copy_out(tag, outgoing_tag(__func__, handle, tag), buffer, buffer_size, required_buffer_size, true);
+}
+
+onesdk_size_t ONESDK_CALL tracer_get_outgoing_dynatrace_byte_tag(agent*, onesdk_tracer_handle_t handle, unsigned char* buffer,
+                                                                 onesdk_size_t buffer_size, onesdk_size_t* required_buffer_size) {
+    char tag[tag_buffer_size];
+    return copy_out(tag, outgoing_tag(__func__, handle, tag), buffer, buffer_size, required_buffer_size, false);
+}
+
+void ONESDK_CALL tracer_set_incoming_dynatrace_string_tag_p(agent*, onesdk_tracer_handle_t handle, str tag) {
+    static thread_local std::string tag_text;
+    assign_string(tag_text, tag);
+    set_incoming_tag(__func__, handle, tag_text.data(), tag_text.size());
+}
+
+void ONESDK_CALL tracer_set_incoming_dynatrace_byte_tag(agent*, onesdk_tracer_handle_t handle, unsigned char const* tag,
+                                                        onesdk_size_t tag_size) {
+    set_incoming_tag(__func__, handle, reinterpret_cast<char const*>(tag), tag ? tag_size : 0);
+}
+
+onesdk_tracer_handle_t ONESDK_CALL outgoingremotecalltracer_create_p(agent*, str service_method, str service_name, str service_endpoint,
+                                                                     onesdk_int32_t channel_type, str channel_endpoint) {
+    return create_tracer("outgoing_remote_call", {
+        { "service_method", service_method },
+        { "service_name", service_name },
+        { "service_endpoint", service_endpoint },
+        { "channel_type", format_int32(channel_type) },
+        { "channel_endpoint", channel_endpoint } });
+}
+
+void ONESDK_CALL outgoingremotecalltracer_set_protocol_name_p(agent*, onesdk_tracer_handle_t handle, str protocol_name) {
+    set_attribute(__func__, handle, "protocol_name", protocol_name);
+}
+
+onesdk_tracer_handle_t ONESDK_CALL incomingremotecalltracer_create_p(agent*, str service_method, str service_name, str service_endpoint) {
+    return create_tracer("incoming_remote_call", {
+        { "service_method", service_method },
+        { "service_name", service_name },
+        { "service_endpoint", service_endpoint } });
+}
+
+void ONESDK_CALL incomingremotecalltracer_set_protocol_name_p(agent*, onesdk_tracer_handle_t handle, str protocol_name) {
+    set_attribute(__func__, handle, "protocol_name", protocol_name);
+}
+
+onesdk_databaseinfo_handle_t ONESDK_CALL databaseinfo_create_p(agent*, str name, str vendor, onesdk_int32_t channel_type,
+                                                               str channel_endpoint) {
+    return create_info({
+        { "database_name", name },
+        { "database_vendor", vendor },
+        { "channel_type", format_int32(channel_type) },
+        { "channel_endpoint", channel_endpoint } });
+}
+
+void ONESDK_CALL databaseinfo_delete(agent*, onesdk_databaseinfo_handle_t handle) {
+    delete_object(__func__, handle, object_kind::info);
+}
+
+onesdk_tracer_handle_t ONESDK_CALL databaserequesttracer_create_sql_p(agent*, onesdk_databaseinfo_handle_t handle, str statement) {
+    return create_tracer_from_info("database_request", handle, { { "statement", statement } });
+}
+
+void ONESDK_CALL databaserequesttracer_set_returned_row_count(agent*, onesdk_tracer_handle_t handle, onesdk_int32_t count) {
+    set_attribute(__func__, handle, "returned_row_count", format_int32(count));
+}
+
+void ONESDK_CALL databaserequesttracer_set_round_trip_count(agent*, onesdk_tracer_handle_t handle, onesdk_int32_t count) {
+    set_attribute(__func__, handle, "round_trip_count", format_int32(count));
+}
+
+onesdk_webapplicationinfo_handle_t ONESDK_CALL webapplicationinfo_create_p(agent*, str web_server_name, str application_id,
+                                                                           str context_root) {
+    return create_info({
+        { "web_server_name", web_server_name },
+        { "application_id", application_id },
+        { "context_root", context_root } });
+}
+
+void ONESDK_CALL webapplicationinfo_delete(agent*, onesdk_webapplicationinfo_handle_t handle) {
+    delete_object(__func__, handle, object_kind::info);
+}
+
+onesdk_tracer_handle_t ONESDK_CALL incomingwebrequesttracer_create_p(agent*, onesdk_webapplicationinfo_handle_t handle, str url,
+                                                                     str method) {
+    return create_tracer_from_info("incoming_web_request", handle, { { "url", url }, { "method", method } });
+}
+
+void ONESDK_CALL incomingwebrequesttracer_set_remote_address_p(agent*, onesdk_tracer_handle_t handle, str remote_address) {
+    set_attribute(__func__, handle, "remote_address", remote_address);
+}
+
+void ONESDK_CALL incomingwebrequesttracer_add_request_headers_p(agent*, onesdk_tracer_handle_t handle, str names, str values,
+                                                                onesdk_size_t count) {
+    add_attributes(__func__, handle, "request_header.", names, values, count);
+}
+
+void ONESDK_CALL incomingwebrequesttracer_add_parameters_p(agent*, onesdk_tracer_handle_t handle, str names, str values,
+                                                           onesdk_size_t count) {
+    add_attributes(__func__, handle, "parameter.", names, values, count);
+}
+
+void ONESDK_CALL incomingwebrequesttracer_add_response_headers_p(agent*, onesdk_tracer_handle_t handle, str names, str values,
+                                                                 onesdk_size_t count) {
+    add_attributes(__func__, handle, "response_header.", names, values, count);
+}
+
+void ONESDK_CALL incomingwebrequesttracer_set_status_code(agent*, onesdk_tracer_handle_t handle, onesdk_int32_t status_code) {
+    set_attribute(__func__, handle, "status_code", format_int32(status_code));
+}
+
+void ONESDK_CALL customrequestattribute_add_integers_p(agent*, str keys, onesdk_int64_t const* values, onesdk_size_t count) {
+    add_request_attributes(__func__, keys, values, count, format_int64);
+}
+
+void ONESDK_CALL customrequestattribute_add_floats_p(agent*, str keys, double const* values, onesdk_size_t count) {
+    add_request_attributes(__func__, keys, values, count, format_double);
+}
+
+void ONESDK_CALL customrequestattribute_add_strings_p(agent*, str keys, str values, onesdk_size_t count) {
+    add_request_attributes(__func__, keys, values, count, [](onesdk_string_t const& value) { return &value; });
+}
+
+// In-process links use the tag format with a different prefix, so they can't be mixed up with tags.
+char const link_prefix[] = "ISL;standin;";
+std::size_t const link_prefix_length = sizeof(link_prefix) - 1;
+
+onesdk_size_t ONESDK_CALL inprocesslink_create(agent*, unsigned char* buffer, onesdk_size_t buffer_size,
+                                               onesdk_size_t* required_buffer_size) {
+    char link[tag_buffer_size];
+    std::size_t link_size = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_agent.mutex);
+        tracer const* const t = g_agent.current_tracer();
+        if (t)
+            link_size = format_tag(link, link_prefix, t->position);
+    }
+    return copy_out(link, link_size, buffer, buffer_size, required_buffer_size, false);
+}
+
+onesdk_tracer_handle_t ONESDK_CALL inprocesslinktracer_create(agent*, unsigned char const* link, onesdk_size_t link_size) {
+    trace_position const position =
+        link ? parse_tag(link_prefix, link_prefix_length, reinterpret_cast<char const*>(link), link_size) : trace_position();
+    if (!position.valid()) {
+        STANDIN_WARN("invalid in-process link");
+        return ONESDK_INVALID_HANDLE;
+    }
+    return create_tracer("inprocess_link", {}, position);
+}
+
+onesdk_tracer_handle_t ONESDK_CALL outgoingwebrequesttracer_create_p(agent*, str url, str method) {
+    return create_tracer("outgoing_web_request", { { "url", url }, { "method", method } });
+}
+
+void ONESDK_CALL outgoingwebrequesttracer_add_request_headers_p(agent*, onesdk_tracer_handle_t handle, str names, str values,
+                                                                onesdk_size_t count) {
+    add_attributes(__func__, handle, "request_header.", names, values, count);
+}
+
+void ONESDK_CALL outgoingwebrequesttracer_add_response_headers_p(agent*, onesdk_tracer_handle_t handle, str names, str values,
+                                                                 onesdk_size_t count) {
+    add_attributes(__func__, handle, "response_header.", names, values, count);
+}
+
+void ONESDK_CALL outgoingwebrequesttracer_set_status_code(agent*, onesdk_tracer_handle_t handle, onesdk_int32_t status_code) {
+    set_attribute(__func__, handle, "status_code", format_int32(status_code));
+}
+
+onesdk_tracer_handle_t ONESDK_CALL customservicetracer_create_p(agent*, str service_method, str service_name) {
+    return create_tracer("custom_service", {
+        { "service_method", service_method },
+        { "service_name", service_name } });
+}
+
+onesdk_messagingsysteminfo_handle_t ONESDK_CALL messagingsysteminfo_create_p(agent*, str vendor_name, str destination_name,
+                                                                             onesdk_int32_t destination_type, onesdk_int32_t channel_type,
+                                                                             str channel_endpoint) {
+    return create_info({
+        { "vendor_name", vendor_name },
+        { "destination_name", destination_name },
+        { "destination_type", format_int32(destination_type) },
+        { "channel_type", format_int32(channel_type) },
+        { "channel_endpoint", channel_endpoint } });
+}
+
+void ONESDK_CALL messagingsysteminfo_delete(agent*, onesdk_messagingsysteminfo_handle_t handle) {
+    delete_object(__func__, handle, object_kind::info);
+}
+
+onesdk_tracer_handle_t ONESDK_CALL outgoingmessagetracer_create(agent*, onesdk_messagingsysteminfo_handle_t handle) {
+    return create_tracer_from_info("outgoing_message", handle, {});
+}
+
+void ONESDK_CALL outgoingmessagetracer_set_vendor_message_id_p(agent*, onesdk_tracer_handle_t handle, str vendor_message_id) {
+    set_attribute(__func__, handle, "vendor_message_id", vendor_message_id);
+}
+
+void ONESDK_CALL outgoingmessagetracer_set_correlation_id_p(agent*, onesdk_tracer_handle_t handle, str correlation_id) {
+    set_attribute(__func__, handle, "correlation_id", correlation_id);
+}
+
+onesdk_tracer_handle_t ONESDK_CALL incomingmessagereceivetracer_create(agent*, onesdk_messagingsysteminfo_handle_t handle) {
+    return create_tracer_from_info("incoming_message_receive", handle, {});
+}
+
+onesdk_tracer_handle_t ONESDK_CALL incomingmessageprocesstracer_create(agent*, onesdk_messagingsysteminfo_handle_t handle) {
+    return create_tracer_from_info("incoming_message_process", handle, {});
+}
+
+void ONESDK_CALL incomingmessageprocesstracer_set_vendor_message_id_p(agent*, onesdk_tracer_handle_t handle, str vendor_message_id) {
+    set_attribute(__func__, handle, "vendor_message_id", vendor_message_id);
+}
+
+void ONESDK_CALL incomingmessageprocesstracer_set_correlation_id_p(agent*, onesdk_tracer_handle_t handle, str correlation_id) {
+    set_attribute(__func__, handle, "correlation_id", correlation_id);
+}
+
+onesdk_int32_t ONESDK_CALL agent_get_fork_state(agent*) {
+    std::lock_guard<std::mutex> lock(g_agent.mutex);
+    if (!g_agent.forkable)
+        return ONESDK_AGENT_FORK_STATE_NOT_FORKABLE;
+    if (g_agent.pid == g_agent.initial_pid)
+        return ONESDK_AGENT_FORK_STATE_PARENT_INITIALIZED;
+    return g_agent.child_used ? ONESDK_AGENT_FORK_STATE_FULLY_INITIALIZED : ONESDK_AGENT_FORK_STATE_PRE_INITIALIZED;
+}
+
+onesdk_result_t ONESDK_CALL agent_set_warning_callback(agent*, onesdk_agent_logging_callback_t* callback) {
+    std::lock_guard<std::mutex> lock(g_agent.mutex);
+    g_agent.warning_callback = callback;
+    return ONESDK_SUCCESS;
+}
+
+onesdk_result_t ONESDK_CALL agent_set_verbose_callback(agent*, onesdk_agent_logging_callback_t* callback) {
+    std::lock_guard<std::mutex> lock(g_agent.mutex);
+    g_agent.verbose_callback = callback;
+    return ONESDK_SUCCESS;
+}
+
+onesdk_result_t ONESDK_CALL tracecontext_get_current(agent*, char* trace_id_buffer, onesdk_size_t trace_id_buffer_size,
+                                                     char* span_id_buffer, onesdk_size_t span_id_buffer_size) {
+    trace_position position;
+    {
+        std::lock_guard<std::mutex> lock(g_agent.mutex);
+        tracer const* const t = g_agent.current_tracer();
+        if (t)
+            position = t->position;
+    }
+
+    char trace_id[ONESDK_TRACE_ID_BUFFER_SIZE];
+    snprintf(trace_id, sizeof(trace_id), "%016llx%016llx", static_cast<unsigned long long>(position.trace_id_high),
+        static_cast<unsigned long long>(position.trace_id_low));
+    char span_id[ONESDK_SPAN_ID_BUFFER_SIZE];
+    snprintf(span_id, sizeof(span_id), "%016llx", static_cast<unsigned long long>(position.span_id));
+
+    onesdk_result_t result = position.valid() ? ONESDK_SUCCESS : ONESDK_ERROR_NO_DATA;
+    if (trace_id_buffer_size != 0 && trace_id_buffer_size < ONESDK_TRACE_ID_BUFFER_SIZE)
+        result = ONESDK_ERROR_INVALID_ARGUMENT;
+    if (span_id_buffer_size != 0 && span_id_buffer_size < ONESDK_SPAN_ID_BUFFER_SIZE)
+        result = ONESDK_ERROR_INVALID_ARGUMENT;
+    copy_out(trace_id, sizeof(trace_id) - 1, trace_id_buffer, trace_id_buffer_size, nullptr, true);
+    copy_out(span_id, sizeof(span_id) - 1, span_id_buffer, span_id_buffer_size, nullptr, true);
+    return result;
+}
+
+agent_functions const g_agent_functions = {
+    agent_add_ref,
+    agent_release,
+    internal_dispatch,
+    agent_get_current_state,
+    agent_set_logging_callback,
+    tracer_start,
+    tracer_end,
+    tracer_error_p,
+    tracer_get_outgoing_dynatrace_string_tag,
+    tracer_get_outgoing_dynatrace_byte_tag,
+    tracer_set_incoming_dynatrace_string_tag_p,
+    tracer_set_incoming_dynatrace_byte_tag,
+    outgoingremotecalltracer_create_p,
+    outgoingremotecalltracer_set_protocol_name_p,
+    incomingremotecalltracer_create_p,
+    incomingremotecalltracer_set_protocol_name_p,
+    databaseinfo_create_p,
+    databaseinfo_delete,
+    databaserequesttracer_create_sql_p,
+    databaserequesttracer_set_returned_row_count,
+    databaserequesttracer_set_round_trip_count,
+    webapplicationinfo_create_p,
+    webapplicationinfo_delete,
+    incomingwebrequesttracer_create_p,
+    incomingwebrequesttracer_set_remote_address_p,
+    incomingwebrequesttracer_add_request_headers_p,
+    incomingwebrequesttracer_add_parameters_p,
+    incomingwebrequesttracer_add_response_headers_p,
+    incomingwebrequesttracer_set_status_code,
+    customrequestattribute_add_integers_p,
+    customrequestattribute_add_floats_p,
+    customrequestattribute_add_strings_p,
+    inprocesslink_create,
+    inprocesslinktracer_create,
+    outgoingwebrequesttracer_create_p,
+    outgoingwebrequesttracer_add_request_headers_p,
+    outgoingwebrequesttracer_add_response_headers_p,
+    outgoingwebrequesttracer_set_status_code,
+    customservicetracer_create_p,
+    messagingsysteminfo_create_p,
+    messagingsysteminfo_delete,
+    outgoingmessagetracer_create,
+    outgoingmessagetracer_set_vendor_message_id_p,
+    outgoingmessagetracer_set_correlation_id_p,
+    incomingmessagereceivetracer_create,
+    incomingmessageprocesstracer_create,
+    incomingmessageprocesstracer_set_vendor_message_id_p,
+    incomingmessageprocesstracer_set_correlation_id_p,
+    agent_get_fork_state,
+    agent_set_warning_callback,
+    agent_set_verbose_callback,
+    tracecontext_get_current,
+};
+
+/*========================================================================================================================================*/
+// Metrics function table
+
+void ONESDK_CALL metric_delete(agent*, onesdk_metric_handle_t handle) {
+    delete_object(__func__, handle, object_kind::metric);
+}
+
+#define STANDIN_METRIC_FUNCTIONS(type, value_type, add_function, is_counter)                                                            \
+    onesdk_metric_handle_t ONESDK_CALL type##metric_create(agent*, str key, str unit, str dimension) {                                  \
+        return create_metric(#type, key, unit, dimension);                                                                              \
+    }                                                                                                                                  \
+    void ONESDK_CALL type##metric_##add_function(agent*, onesdk_metric_handle_t handle, value_type value, str dimension) {               \
+        add_metric_value(__func__, handle, static_cast<double>(value), dimension, is_counter);                                          \
+    }
+
+STANDIN_METRIC_FUNCTIONS(integercounter, onesdk_int64_t, increase_by, true)
+STANDIN_METRIC_FUNCTIONS(floatcounter, double, increase_by, true)
+STANDIN_METRIC_FUNCTIONS(integergauge, onesdk_int64_t, set_value, false)
+STANDIN_METRIC_FUNCTIONS(floatgauge, double, set_value, false)
+STANDIN_METRIC_FUNCTIONS(integerstatistics, onesdk_int64_t, add_value, false)
+STANDIN_METRIC_FUNCTIONS(floatstatistics, double, add_value, false)
+
+metrics_functions const g_metrics_functions = {
+    metric_delete,
+    integercountermetric_create,
+    floatcountermetric_create,
+    integergaugemetric_create,
+    floatgaugemetric_create,
+    integerstatisticsmetric_create,
+    floatstatisticsmetric_create,
+    integercountermetric_increase_by,
+    floatcountermetric_increase_by,
+    integergaugemetric_set_value,
+    floatgaugemetric_set_value,
+    integerstatisticsmetric_add_value,
+    floatstatisticsmetric_add_value,
+};
+
+/*========================================================================================================================================*/
+// Tracer extension function table
+
+onesdk_bool_t ONESDK_CALL tracer_start_2(agent*, onesdk_tracer_handle_t handle, onesdk_tracer_handle_t parent_handle,
+                                         onesdk_int64_t start_time) {
+    start_tracer(__func__, handle, parent_handle, start_time);
+    return 1;
+}
+
+void ONESDK_CALL tracer_end_timed(agent*, onesdk_tracer_handle_t handle, onesdk_int64_t end_time) {
+    end_tracer(__func__, handle, end_time);
+}
+
+tracer_ext_functions const g_tracer_ext_functions = {
+    tracer_start_2,
+    tracer_end_timed,
+};
+
+/*========================================================================================================================================*/
+// Library
+
+void set_error(onesdk_xchar_t* error_buffer, onesdk_size_t error_buffer_size, std::string const& message) {
+    if (error_buffer && error_buffer_size != 0)
+        snprintf(error_buffer, error_buffer_size, "%s", message.c_str());
+}
+
+onesdk_xchar_t const* ONESDK_CALL get_agent_version_string() {
+    return "1.0.0 (stand-in agent)";
+}
+
+onesdk_result_t ONESDK_CALL get_agent(stub_version const* version, agent** agent_out, agent_functions const** functions_out,
+                                      onesdk_xchar_t* error_buffer, onesdk_size_t error_buffer_size) {
+    if (version == nullptr || agent_out == nullptr || functions_out == nullptr)
+        return ONESDK_ERROR_INVALID_ARGUMENT;
+    if (version->version_major != 1) {
+        set_error(error_buffer, error_buffer_size, "unsupported stub version");
+        return ONESDK_ERROR_INVALID_AGENT_BINARY;
+    }
+    *agent_out = &g_agent;
+    *functions_out = &g_agent_functions;
+    return ONESDK_SUCCESS;
+}
+
+library_functions const g_library_functions = {
+    get_agent_version_string,
+    get_agent,
+};
+
+// fork() handlers: flush the output file before forking, give the child its own file and an empty store.
+void prepare_fork() {
+    g_agent.mutex.lock();
+    if (g_agent.output)
+        fflush(g_agent.output);
+}
+
+void parent_after_fork() {
+    g_agent.mutex.unlock();
+}
+
+void child_after_fork() {
+    g_agent.pid = getpid();
+    g_agent.clear_records();
+    g_agent.counters = onesdk_standin_counters_t();
+    if (g_agent.output) {
+        fclose(g_agent.output);
+        std::string const path = g_agent.output_path + "." + std::to_string(static_cast<long long>(g_agent.pid));
+        g_agent.output = fopen(path.c_str(), "a");
+    }
+    g_agent.mutex.unlock();
+}
+
+bool starts_with(std::string const& s, char const* prefix) {
+    return s.compare(0, strlen(prefix), prefix) == 0;
+}
+
+} // namespace
+
+/*========================================================================================================================================*/
+// Exported functions
+
+ONESDK_STANDIN_EXPORT onesdk_result_t ONESDK_CALL sdkagent_abi_initialize(onesdk_size_t argc, onesdk_xchar_t const* const* argv,
+                                                                          onesdk_xchar_t* error_buffer, onesdk_size_t error_buffer_size) {
+    static std::once_flag register_fork_handlers;
+    std::call_once(register_fork_handlers, [] { pthread_atfork(prepare_fork, parent_after_fork, child_after_fork); });
+
+    std::lock_guard<std::mutex> lock(g_agent.mutex);
+    std::size_t const previous_max_records = g_agent.max_records;
+    g_agent.max_records = 10000;
+    g_agent.check_handles = false;
+    for (onesdk_size_t i = 0; i < argc; i++) {
+        std::string const arg = argv[i] ? argv[i] : "";
+        std::string::size_type const separator = arg.find('=');
+        if (separator == std::string::npos)
+            continue;
+        std::string const key = arg.substr(0, separator);
+        std::string const value = arg.substr(separator + 1);
+
+        if (key == "standin_output") {
+            g_agent.output_path = value;
+        } else if (key == "standin_max_records") {
+            g_agent.max_records = static_cast<std::size_t>(strtoull(value.c_str(), nullptr, 10));
+        } else if (key == "standin_check_handles") {
+            g_agent.check_handles = strtoul(value.c_str(), nullptr, 10) != 0;
+        } else if (key == "standin_state") {
+            if (value == "active") {
+                g_agent.configured_state = ONESDK_AGENT_STATE_ACTIVE;
+            } else if (value == "temporarily_inactive") {
+                g_agent.configured_state = ONESDK_AGENT_STATE_TEMPORARILY_INACTIVE;
+            } else if (value == "permanently_inactive") {
+                g_agent.configured_state = ONESDK_AGENT_STATE_PERMANENTLY_INACTIVE;
+            } else {
+                set_error(error_buffer, error_buffer_size, "invalid standin_state '" + value + "'");
+                return ONESDK_ERROR_INVALID_ARGUMENT;
+            }
+        } else if (starts_with(key, "ONESDK_INTERNAL_") && key.size() > 11 && key.compare(key.size() - 11, 11, "_INIT_FLAGS") == 0) {
+            g_agent.forkable = (strtoul(value.c_str(), nullptr, 10) & ONESDK_INIT_FLAG_FORKABLE) != 0;
+        }
+    }
+
+    if (g_agent.max_records != previous_max_records) {
+        // The ring buffer positions depend on max_records.
+        g_agent.records.clear();
+        g_agent.clear_records();
+    }
+    g_agent.pid = g_agent.initial_pid = getpid();
+    g_agent.child_used = false;
+    if (!g_agent.output_path.empty()) {
+        g_agent.output = fopen(g_agent.output_path.c_str(), "a");
+        if (!g_agent.output) {
+            set_error(error_buffer, error_buffer_size, "can't open standin_output file '" + g_agent.output_path + "'");
+            return ONESDK_ERROR_GENERIC;
+        }
+    }
+    return ONESDK_SUCCESS;
+}
+
+ONESDK_STANDIN_EXPORT onesdk_result_t ONESDK_CALL sdkagent_abi_get_library(onesdk_uint32_t id, onesdk_uint32_t version,
+                                                                           void const** library, onesdk_xchar_t* error_buffer,
+                                                                           onesdk_size_t error_buffer_size) {
+    if (library == nullptr)
+        return ONESDK_ERROR_INVALID_ARGUMENT;
+    if (version == library_version_agent) {
+        switch (id) {
+        case library_id_agent: *library = &g_library_functions; return ONESDK_SUCCESS;
+        case library_id_metrics: *library = &g_metrics_functions; return ONESDK_SUCCESS;
+        case library_id_tracer_ext: *library = &g_tracer_ext_functions; return ONESDK_SUCCESS;
+        default: break;
+        }
+    }
+    set_error(error_buffer, error_buffer_size, "interface not supported by the stand-in agent");
+    return ONESDK_ERROR_INTERFACE_NOT_SUPPORTED;
+}
+
+ONESDK_STANDIN_EXPORT onesdk_result_t ONESDK_CALL sdkagent_abi_shutdown(void) {
+    std::lock_guard<std::mutex> lock(g_agent.mutex);
+    if (g_agent.output) {
+        g_agent.visit_metrics([](std::string const& record) {
+            fputs(record.c_str(), g_agent.output);
+            fputc('\n', g_agent.output);
+        });
+        fclose(g_agent.output);
+        g_agent.output = nullptr;
+    }
+    g_agent.output_path.clear();
+    g_agent.configured_state = ONESDK_AGENT_STATE_ACTIVE;
+    g_agent.forkable = false;
+    g_agent.warning_callback = nullptr;
+    g_agent.verbose_callback = nullptr;
+    return ONESDK_SUCCESS;
+}
+
+ONESDK_STANDIN_EXPORT void ONESDK_CALL onesdk_standin_get_counters(onesdk_standin_counters_t* counters) {
+    if (counters == nullptr)
+        return;
+    std::lock_guard<std::mutex> lock(g_agent.mutex);
+    *counters = g_agent.counters;
+}
+
+ONESDK_STANDIN_EXPORT onesdk_size_t ONESDK_CALL onesdk_standin_visit_records(onesdk_standin_record_callback_t* callback, void* context) {
+    if (callback == nullptr)
+        return 0;
+    std::lock_guard<std::mutex> lock(g_agent.mutex);
+    g_agent.visit_records([&](std::string const& record) { callback(record.c_str(), context); });
+    std::size_t const metric_count = g_agent.visit_metrics([&](std::string const& record) { callback(record.c_str(), context); });
+    return static_cast<onesdk_size_t>(g_agent.record_count + metric_count);
+}
+
+ONESDK_STANDIN_EXPORT void ONESDK_CALL onesdk_standin_clear(void) {
+    std::lock_guard<std::mutex> lock(g_agent.mutex);
+    g_agent.clear();
+}
@@ -0,0 +1,119 @@
+/*
+    Copyright 2017-2019 Dynatrace LLC
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef ONESDK_STANDIN_AGENT_H_INCLUDED
+#define ONESDK_STANDIN_AGENT_H_INCLUDED
+
+/** @file
+    @brief Declares the query functions of the stand-in agent module (libonesdk_standin_agent.so).
+
+    The stand-in agent implements the agent interface that the SDK stub loads, so that the SDK can be initialized and used on machines
+    without a OneAgent (e.g. for tests and benchmarks). It is selected by setting the `agentlibrary` SDK variable before calling
+    @ref onesdk_initialize:
+
+    @code{.c}
+    onesdk_stub_set_variable("agentlibrary=/path/to/libonesdk_standin_agent.so", 0);
+    onesdk_stub_set_variable("standin_output=/tmp/tracers.jsonl", 0); // optional
+    onesdk_initialize();
+    @endcode
+
+    (or by passing `--dt_agentlibrary=...` on the command line or setting the `DT_AGENTLIBRARY` environment variable).
+
+    Every ended tracer is stored as one JSON record (one line) in memory and, if `standin_output` is set, appended to that file. Metric
+    values are aggregated and written as one JSON record per metric and dimension value when the SDK is shut down. The agent is
+    configured with these SDK variables:
+
+    - `standin_output=<path>`       Append records to the file at `<path>`. Forked child processes append to `<path>.<pid>`.
+    - `standin_max_records=<n>`     Keep at most `<n>` tracer records in memory (default 10000), older records are discarded first.
+    - `standin_state=<state>`       Report `active` (the default), `temporarily_inactive` or `permanently_inactive` as agent state.
+    - `standin_check_handles=1`     Also report tracer calls from threads other than the one that created the tracer (not only
+                                    @ref onesdk_tracer_end) and add the decoded handle to every tracer handle warning.
+
+    Handles are `(generation << 32) | (slot index + 1)`: every object lives in a slot of a table, and the generation of the slot is
+    incremented when the object is ended or deleted. So a lookup is an index and a compare, and a handle that is used after its object was
+    ended is recognized as such (even if the slot has been reused) instead of referring to another object. Misuse of tracer handles is
+    reported to the warning callback and counted: `tracers_used_after_end`, `tracers_ended_twice` and `tracers_used_on_other_thread` in
+    @ref onesdk_standin_counters_t. With `standin_check_handles=1` the warnings look like this:
+
+    @code{.unparsed}
+    [stand-in agent] tracer_end: tracer ended twice (handle 0x0000000100000003: slot 2, generation 1, custom_service tracer ended on thread 1)
+    @endcode
+
+    Calls from other threads are still carried out (the OneAgent ignores them), so tests see the same records with and without the option.
+
+    Ended tracers are kept in a pool of the thread that ended them (up to 256 per thread) and reused by the next tracers created on that
+    thread, together with the memory of their attribute strings. Records are stored in a ring buffer of `standin_max_records` strings that
+    are reused as well. So once every thread's pool holds as many tracers as the thread has open at a time and the record store has been
+    filled once, creating, starting and ending tracers and adding attributes doesn't allocate memory, as long as the strings are no longer
+    than the strings they replace. Latin-1 and UTF-16 strings are converted to UTF-8 directly into the reused memory, so this holds for
+    them as well (their length is compared after conversion). `tracers_allocated` in @ref onesdk_standin_counters_t counts the tracers
+    that had to be allocated.
+
+    The stub loads the module with `dlopen`, the functions declared here can be looked up with
+    `dlsym(dlopen(path, RTLD_NOW | RTLD_NOLOAD), "onesdk_standin_get_counters")` and so on.
+*/
+
+/*========================================================================================================================================*/
+
+#include "onesdk/onesdk_common.h"
+
+#if defined(__GNUC__) && ((__GNUC__ + 0) >= 4)
+#    define ONESDK_STANDIN_EXPORT ONESDK_DECLARE_EXTERN_C __attribute__((visibility("default")))
+#else
+#    define ONESDK_STANDIN_EXPORT ONESDK_DECLARE_EXTERN_C
+#endif
+
+/*========================================================================================================================================*/
+
+/** @brief Counters that describe what the stand-in agent has recorded so far. */
+typedef struct onesdk_standin_counters {
+    onesdk_uint64_t tracers_created;        /**< @brief The number of tracers that were created. */
+    onesdk_uint64_t tracers_ended;          /**< @brief The number of tracers that were started and ended. */
+    onesdk_uint64_t records_discarded;      /**< @brief The number of tracer records that were discarded because the memory store was full. */
+    onesdk_uint64_t metric_values;          /**< @brief The number of metric values that were reported. */
+    onesdk_uint64_t request_attributes;     /**< @brief The number of custom request attributes that were added to a tracer. */
+    onesdk_uint64_t misuses;                /**< @brief The number of calls that were ignored because of an unknown handle or invalid state. */
+    onesdk_uint64_t tracers_allocated;      /**< @brief The number of tracers that couldn't reuse a pooled tracer object and were allocated. */
+    onesdk_uint64_t tracers_used_after_end; /**< @brief The number of tracer calls (other than @ref onesdk_tracer_end) with an ended tracer. */
+    onesdk_uint64_t tracers_ended_twice;    /**< @brief The number of @ref onesdk_tracer_end calls with an already ended tracer. */
+    onesdk_uint64_t tracers_used_on_other_thread; /**< @brief The number of tracer calls from a thread that didn't create the tracer,
+                                                             see `standin_check_handles`. */
+} onesdk_standin_counters_t;
+
+/** @brief A function that receives one JSON record, see @ref onesdk_standin_visit_records. */
+typedef void ONESDK_CALL onesdk_standin_record_callback_t(char const* record, void* context);
+
+/** @brief Retrieves the current counters. */
+typedef void ONESDK_CALL onesdk_standin_get_counters_t(onesdk_standin_counters_t* counters);
+
+/** @brief Calls @p callback for every tracer record in memory (oldest first) and then for every metric. Returns the number of calls.
+
+    @p callback is called while the stand-in agent is locked, it must not call any SDK function.
+*/
+typedef onesdk_size_t ONESDK_CALL onesdk_standin_visit_records_t(onesdk_standin_record_callback_t* callback, void* context);
+
+/** @brief Discards all tracer records and metric values in memory and resets the counters. */
+typedef void ONESDK_CALL onesdk_standin_clear_t(void);
+
+/** @cond */
+ONESDK_STANDIN_EXPORT void ONESDK_CALL onesdk_standin_get_counters(onesdk_standin_counters_t* counters);
+ONESDK_STANDIN_EXPORT onesdk_size_t ONESDK_CALL onesdk_standin_visit_records(onesdk_standin_record_callback_t* callback, void* context);
+ONESDK_STANDIN_EXPORT void ONESDK_CALL onesdk_standin_clear(void);
+/** @endcond */
+
+/*========================================================================================================================================*/
+
+#endif /* ONESDK_STANDIN_AGENT_H_INCLUDED */
@@ -0,0 +1,166 @@
+/*
+    Copyright 2017-2019 Dynatrace LLC
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+// Tests for onesdk_databaserequesttracer_submit_batch. Run with the argument "inactive", the stand-in agent reports
+// the state temporarily_inactive and only the inactive agent test is run.
+
+#include "test_util.h"
+
+#include <string>
+#include <vector>
+
+#include <string.h>
+
+namespace {
+
+onesdk_databaseinfo_handle_t create_databaseinfo() {
+    return onesdk_databaseinfo_create(onesdk_asciistr("db"), onesdk_asciistr(ONESDK_DATABASE_VENDOR_MYSQL),
+        ONESDK_CHANNEL_TYPE_TCP_IP, onesdk_asciistr("localhost:3306"));
+}
+
+void test_batch(test::standin_agent const& agent) {
+    onesdk_databaserequest_t requests[3];
+    memset(requests, 0, sizeof(requests));
+    requests[0].statement = onesdk_asciistr("INSERT INTO t VALUES (?)");
+    requests[0].start_time = 1500000000000000;
+    requests[0].end_time = 1500000000000250;
+    requests[0].returned_row_count = 1;
+    requests[0].round_trip_count = 2;
+    requests[1].statement = onesdk_asciistr("UPDATE t SET a = ?");
+    requests[1].start_time = 1500000000001000;
+    requests[1].end_time = 1500000000001500;
+    requests[1].returned_row_count = -1;
+    requests[1].round_trip_count = -1;
+    requests[1].error_class = onesdk_asciistr("SQLException");
+    requests[1].error_message = onesdk_asciistr("deadlock");
+    requests[2].statement = onesdk_asciistr("COMMIT");
+    requests[2].start_time = 1500000000002000;
+    requests[2].end_time = 1500000000002010;
+    requests[2].returned_row_count = 0;
+    requests[2].round_trip_count = -1;
+
+    agent.clear();
+    onesdk_databaseinfo_handle_t const databaseinfo = create_databaseinfo();
+    onesdk_databaserequesttracer_submit_batch(databaseinfo, requests, 3);
+    onesdk_databaseinfo_delete(databaseinfo);
+
+    std::vector<std::string> const records = agent.records();
+    TEST_CHECK(records.size() == 3);
+    if (records.size() == 3) {
+        // The entries are traced in order, each with its own times.
+        TEST_CHECK(test::field(records[0], "type") == "database_request");
+        TEST_CHECK(test::contains(records[0], "[\"statement\",\"INSERT INTO t VALUES (?)\"]"));
+        TEST_CHECK(test::number_field(records[0], "start_time") == "1500000000000000");
+        TEST_CHECK(test::number_field(records[0], "end_time") == "1500000000000250");
+        TEST_CHECK(test::contains(records[0], "[\"returned_row_count\",\"1\"]"));
+        TEST_CHECK(test::contains(records[0], "[\"round_trip_count\",\"2\"]"));
+        TEST_CHECK(!test::contains(records[0], "\"error_class\""));
+
+        // Negative counts are not reported.
+        TEST_CHECK(test::contains(records[1], "[\"statement\",\"UPDATE t SET a = ?\"]"));
+        TEST_CHECK(test::number_field(records[1], "start_time") == "1500000000001000");
+        TEST_CHECK(test::number_field(records[1], "end_time") == "1500000000001500");
+        TEST_CHECK(!test::contains(records[1], "returned_row_count"));
+        TEST_CHECK(!test::contains(records[1], "round_trip_count"));
+        TEST_CHECK(test::contains(records[1], "\"error_class\":\"SQLException\""));
+        TEST_CHECK(test::contains(records[1], "\"error_message\":\"deadlock\""));
+
+        TEST_CHECK(test::contains(records[2], "[\"statement\",\"COMMIT\"]"));
+        TEST_CHECK(test::number_field(records[2], "start_time") == "1500000000002000");
+        TEST_CHECK(test::number_field(records[2], "end_time") == "1500000000002010");
+        TEST_CHECK(test::contains(records[2], "[\"returned_row_count\",\"0\"]"));
+        TEST_CHECK(!test::contains(records[2], "round_trip_count"));
+        TEST_CHECK(!test::contains(records[2], "\"error_class\""));
+    }
+    TEST_CHECK(agent.counters().tracers_created == 3);
+    TEST_CHECK(agent.counters().tracers_ended == 3);
+    TEST_CHECK(agent.counters().misuses == 0);
+}
+
+void test_batch_is_child_of_active_tracer(test::standin_agent const& agent) {
+    onesdk_databaserequest_t request;
+    memset(&request, 0, sizeof(request));
+    request.statement = onesdk_asciistr("SELECT 1");
+    request.returned_row_count = -1;
+    request.round_trip_count = -1;
+
+    agent.clear();
+    onesdk_databaseinfo_handle_t const databaseinfo = create_databaseinfo();
+    onesdk_tracer_handle_t const parent = onesdk_customservicetracer_create(onesdk_asciistr("method"), onesdk_asciistr("Service"));
+    onesdk_tracer_start(parent);
+    onesdk_databaserequesttracer_submit_batch(databaseinfo, &request, 1);
+    onesdk_tracer_end(parent);
+    onesdk_databaseinfo_delete(databaseinfo);
+
+    std::vector<std::string> const records = agent.records();
+    TEST_CHECK(records.size() == 2);
+    if (records.size() == 2)
+        TEST_CHECK(test::field(records[0], "parent_span_id") == test::field(records[1], "span_id"));
+}
+
+void test_empty_batch(test::standin_agent const& agent) {
+    onesdk_databaserequest_t request;
+    memset(&request, 0, sizeof(request));
+
+    agent.clear();
+    onesdk_databaseinfo_handle_t const databaseinfo = create_databaseinfo();
+    onesdk_databaserequesttracer_submit_batch(databaseinfo, &request, 0);
+    onesdk_databaserequesttracer_submit_batch(databaseinfo, NULL, 0);
+    onesdk_databaserequesttracer_submit_batch(ONESDK_INVALID_HANDLE, &request, 1);
+    onesdk_databaseinfo_delete(databaseinfo);
+
+    TEST_CHECK(agent.records().empty());
+    TEST_CHECK(agent.counters().tracers_created == 0);
+    TEST_CHECK(agent.counters().misuses == 0);
+}
+
+void test_inactive_agent(test::standin_agent const& agent) {
+    TEST_CHECK(onesdk_agent_get_current_state() == ONESDK_AGENT_STATE_TEMPORARILY_INACTIVE);
+
+    onesdk_databaserequest_t requests[2];
+    memset(requests, 0, sizeof(requests));
+    requests[0].statement = onesdk_asciistr("SELECT 1");
+    requests[1].statement = onesdk_asciistr("SELECT 2");
+
+    agent.clear();
+    onesdk_databaseinfo_handle_t const databaseinfo = create_databaseinfo();
+    onesdk_databaserequesttracer_submit_batch(databaseinfo, requests, 2);
+    onesdk_databaseinfo_delete(databaseinfo);
+
+    TEST_CHECK(agent.records().empty());
+    TEST_CHECK(agent.counters().tracers_created == 0);
+    TEST_CHECK(agent.counters().misuses == 0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "inactive") == 0) {
+        test::standin_agent const agent("standin_state=temporarily_inactive");
+        onesdk_ex_api_enable_tracer_ext();
+        test_inactive_agent(agent);
+        return test::result();
+    }
+
+    test::standin_agent const agent;
+    onesdk_ex_api_enable_tracer_ext();
+
+    test_batch(agent);
+    test_batch_is_child_of_active_tracer(agent);
+    test_empty_batch(agent);
+
+    return test::result();
+}
@@ -0,0 +1,175 @@
+/*
+    Copyright 2017-2019 Dynatrace LLC
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+// Tests for the background thread helpers in onesdk_cpp_async.h.
+
+#include "test_util.h"
+
+#include "onesdk/onesdk_cpp.h"
+#include "onesdk/onesdk_cpp_async.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Waits up to five seconds until the submitter has executed @p count tasks.
+bool wait_for_executed(onesdk::async_submitter const& submitter, unsigned long long count) {
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (submitter.executed_count() < count) {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+void test_submitter_executes_tasks(test::standin_agent const& agent) {
+    agent.clear();
+    {
+        onesdk::async_submitter submitter;
+        for (int i = 0; i < 10; i++) {
+            TEST_CHECK(submitter.submit([]() noexcept {
+                onesdk::custom_service_tracer tracer(onesdk::asciistr("task"), onesdk::asciistr("Service"));
+                tracer.start();
+            }));
+        }
+        TEST_CHECK(submitter.submitted_count() == 10);
+    }
+    TEST_CHECK(agent.counters().tracers_ended == 10);
+    TEST_CHECK(agent.counters().misuses == 0);
+}
+
+void test_submitter_wakes_sleeping_worker() {
+    onesdk::async_submitter submitter;
+    TEST_CHECK(submitter.submit([]() noexcept {}));
+    TEST_CHECK(wait_for_executed(submitter, 1));
+
+    // Give the worker time to go to sleep, the next submission has to wake it up.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    TEST_CHECK(submitter.submit([]() noexcept {}));
+    TEST_CHECK(wait_for_executed(submitter, 2));
+}
+
+void test_submitter_drops_tasks_when_full() {
+    std::atomic<bool> release(false);
+    std::atomic<bool>* const release_pointer = &release;
+    onesdk::async_submitter submitter(2);
+
+    // The first task blocks the ring buffer until it is released, so it holds one more task and drops the rest.
+    TEST_CHECK(submitter.submit([release_pointer]() noexcept {
+        while (!release_pointer->load())
+            std::this_thread::yield();
+    }));
+    TEST_CHECK(submitter.submit([]() noexcept {}));
+    TEST_CHECK(!submitter.submit([]() noexcept {}));
+    TEST_CHECK(!submitter.submit([]() noexcept {}));
+    TEST_CHECK(submitter.submitted_count() == 2);
+    TEST_CHECK(submitter.dropped_count() == 2);
+
+    release.store(true);
+    TEST_CHECK(wait_for_executed(submitter, 2));
+}
+
+void test_many_submitters_on_one_thread() {
+    // Each submitter registers a ring buffer for this thread, registrations of destroyed submitters must not get in the way.
+    for (int i = 0; i < 100; i++) {
+        onesdk::async_submitter submitter(4);
+        TEST_CHECK(submitter.submit([]() noexcept {}));
+        TEST_CHECK(wait_for_executed(submitter, 1));
+    }
+}
+
+void test_linking_executor(test::standin_agent const& agent) {
+    agent.clear();
+    std::vector<std::thread> threads;
+    auto executor = onesdk::make_linking_executor([&threads](std::function<void()> task) { threads.emplace_back(std::move(task)); });
+    {
+        onesdk::custom_service_tracer tracer(onesdk::asciistr("submitter"), onesdk::asciistr("Service"));
+        tracer.start();
+        executor([] {
+            onesdk::custom_service_tracer child(onesdk::asciistr("task"), onesdk::asciistr("Service"));
+            child.start();
+        });
+        for (std::thread& t : threads)
+            t.join();
+    }
+
+    // Ended in order: task, in-process link, submitter.
+    std::vector<std::string> const records = agent.records();
+    TEST_CHECK(records.size() == 3);
+    if (records.size() == 3) {
+        TEST_CHECK(test::field(records[1], "type") == "inprocess_link");
+        TEST_CHECK(test::field(records[0], "parent_span_id") == test::field(records[1], "span_id"));
+        TEST_CHECK(test::field(records[1], "parent_span_id") == test::field(records[2], "span_id"));
+        TEST_CHECK(test::field(records[0], "trace_id") == test::field(records[2], "trace_id"));
+        TEST_CHECK(!test::number_field(records[0], "thread").empty());
+        TEST_CHECK(test::number_field(records[0], "thread") != test::number_field(records[2], "thread"));
+    }
+    TEST_CHECK(agent.counters().misuses == 0);
+}
+
+void test_linked_task_error(test::standin_agent const& agent) {
+    agent.clear();
+    bool rethrown = false;
+    {
+        onesdk::custom_service_tracer tracer(onesdk::asciistr("submitter"), onesdk::asciistr("Service"));
+        tracer.start();
+        auto task = onesdk::link_task([] { throw std::runtime_error("task failed"); });
+        try {
+            task();
+        } catch (std::runtime_error const&) {
+            rethrown = true;
+        }
+    }
+    TEST_CHECK(rethrown);
+    std::vector<std::string> const records = agent.records();
+    TEST_CHECK(records.size() == 2);
+    if (records.size() == 2) {
+        TEST_CHECK(test::field(records[0], "type") == "inprocess_link");
+        TEST_CHECK(test::field(records[0], "error_message") == "task failed");
+    }
+}
+
+void test_unlinked_task() {
+    // Without an active tracer, the link is empty and the task runs without a tracer.
+    int calls = 0;
+    auto task = onesdk::link_task([&calls](int n) { calls += n; return calls; });
+    TEST_CHECK(task(2) == 2);
+    TEST_CHECK(task(3) == 5);
+}
+
+} // namespace
+
+int main() {
+    test::standin_agent const agent;
+    onesdk::refresh_agent_state();
+
+    test_submitter_executes_tasks(agent);
+    test_submitter_wakes_sleeping_worker();
+    test_submitter_drops_tasks_when_full();
+    test_many_submitters_on_one_thread();
+    test_linking_executor(agent);
+    test_linked_task_error(agent);
+    test_unlinked_task();
+
+    return test::result();
+}
@@ -0,0 +1,140 @@
+/*
+    Copyright 2017-2019 Dynatrace LLC
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+// Tests for the C++20 coroutine helpers in onesdk_cpp_coroutine.h.
+
+#include "test_util.h"
+
+#include "onesdk/onesdk_cpp.h"
+#include "onesdk/onesdk_cpp_coroutine.h"
+
+#include <coroutine>
+#include <exception>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// A coroutine that starts running immediately and can't be awaited.
+struct fire_and_forget {
+    struct promise_type {
+        fire_and_forget get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+// Suspends the awaiting coroutine and hands out its handle, so that the test can resume it on another thread.
+struct resume_later {
+    std::coroutine_handle<>* handle;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) noexcept { *handle = h; }
+    void await_resume() const noexcept {}
+};
+
+void start_child(char const* name) {
+    onesdk::custom_service_tracer child(onesdk::asciistr(name), onesdk::asciistr("Service"));
+    child.start();
+}
+
+fire_and_forget traced_coroutine(std::coroutine_handle<>& suspended, bool& finished) {
+    onesdk::coroutine_context context = onesdk::coroutine_context::capture();
+    onesdk::context_scope const scope(context);
+    TEST_CHECK(context.active());
+    start_child("before");
+
+    co_await onesdk::with_context(context, resume_later{ &suspended });
+
+    TEST_CHECK(context.active());
+    start_child("after");
+    finished = true;
+}
+
+void test_context_follows_coroutine(test::standin_agent const& agent) {
+    agent.clear();
+    std::coroutine_handle<> suspended;
+    bool finished = false;
+    {
+        onesdk::custom_service_tracer request(onesdk::asciistr("request"), onesdk::asciistr("Service"));
+        request.start();
+
+        traced_coroutine(suspended, finished);
+        TEST_CHECK(suspended);
+
+        // While the coroutine is suspended, the thread serves other work of the request.
+        start_child("sibling");
+
+        std::thread([suspended] { suspended.resume(); }).join();
+        TEST_CHECK(finished);
+    }
+
+    // Ended in order: before, link, sibling, after, link, request.
+    std::vector<std::string> const records = agent.records();
+    TEST_CHECK(records.size() == 6);
+    if (records.size() == 6) {
+        std::string const request_span = test::field(records[5], "span_id");
+        TEST_CHECK(test::field(records[1], "type") == "inprocess_link");
+        TEST_CHECK(test::field(records[4], "type") == "inprocess_link");
+        TEST_CHECK(test::field(records[0], "parent_span_id") == test::field(records[1], "span_id"));
+        TEST_CHECK(test::field(records[1], "parent_span_id") == request_span);
+        TEST_CHECK(test::field(records[2], "parent_span_id") == request_span);
+        TEST_CHECK(test::field(records[3], "parent_span_id") == test::field(records[4], "span_id"));
+        TEST_CHECK(test::field(records[4], "parent_span_id") == request_span);
+        TEST_CHECK(test::number_field(records[1], "thread") != test::number_field(records[4], "thread"));
+        for (std::string const& record : records)
+            TEST_CHECK(test::field(record, "trace_id") == test::field(records[5], "trace_id"));
+    }
+    TEST_CHECK(agent.counters().misuses == 0);
+}
+
+void test_coroutine_context_names(test::standin_agent const& agent) {
+    agent.clear();
+    {
+        onesdk::custom_service_tracer request(onesdk::asciistr("request"), onesdk::asciistr("Service"));
+        request.start();
+        onesdk::coroutine_context context = onesdk::coroutine_context::capture();
+        TEST_CHECK(!context.active());
+        context.activate();
+        TEST_CHECK(context.active());
+        TEST_CHECK(context.attached());
+        context.deactivate();
+        TEST_CHECK(!context.active());
+
+        // The awaiter and the scope accept any request_context.
+        onesdk::request_context& base = context;
+        onesdk::context_scope const scope(base);
+        TEST_CHECK(context.active());
+    }
+    TEST_CHECK(agent.counters().tracers_ended == 3);
+    TEST_CHECK(agent.counters().misuses == 0);
+}
+
+} // namespace
+
+int main() {
+    test::standin_agent const agent;
+    onesdk::refresh_agent_state();
+
+    test_context_follows_coroutine(agent);
+    test_coroutine_context_names(agent);
+
+    return test::result();
+}
@@ -0,0 +1,106 @@
+/*
+    Copyright 2017-2019 Dynatrace LLC
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+// Tests for the SQL statement helpers in onesdk_cpp_sql.h.
+
+#include "test_util.h"
+
+#include "onesdk/onesdk_cpp.h"
+#include "onesdk/onesdk_cpp_sql.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+
+namespace {
+
+bool normalizes_to(char const* sql, char const* expected) {
+    onesdk::sql_statement_cache cache;
+    std::string const normalized = *cache.normalize(sql);
+    if (normalized != expected) {
+        fprintf(stderr, "normalize(\"%s\") returned \"%s\", expected \"%s\"\n", sql, normalized.c_str(), expected);
+        return false;
+    }
+    return true;
+}
+
+void test_literals() {
+    TEST_CHECK(normalizes_to("SELECT * FROM t WHERE a = 'secret' AND b = 42", "SELECT * FROM t WHERE a = ? AND b = ?"));
+    TEST_CHECK(normalizes_to("a = 'it''s a secret' AND b = 1", "a = ? AND b = ?"));
+    TEST_CHECK(normalizes_to("a = 'it\\'s a secret' AND b = 1", "a = ? AND b = ?"));
+    TEST_CHECK(normalizes_to("a = 'ends with a backslash\\\\' AND b = 1", "a = ? AND b = ?"));
+    TEST_CHECK(normalizes_to("x IN (1.5, 1.5e-3, 0x1F, -7)", "x IN (?, ?, ?, -?)"));
+    TEST_CHECK(normalizes_to("a = 'unterminated", "a = ?"));
+}
+
+void test_kept_text() {
+    TEST_CHECK(normalizes_to("SELECT t1.col2 FROM \"table 1\" JOIN `t2` ON t1.id3 = t2.id",
+                             "SELECT t1.col2 FROM \"table 1\" JOIN `t2` ON t1.id3 = t2.id"));
+    TEST_CHECK(normalizes_to("WHERE a = ? AND b = :1 AND c = :name", "WHERE a = ? AND b = :1 AND c = :name"));
+    TEST_CHECK(normalizes_to("WHERE a = $1 AND b = @p1 AND c = @2", "WHERE a = $1 AND b = @p1 AND c = @2"));
+    TEST_CHECK(normalizes_to("SELECT a::int FROM t LIMIT 10", "SELECT a::int FROM t LIMIT ?"));
+}
+
+void test_cache() {
+    onesdk::sql_statement_cache cache(2);
+    std::shared_ptr<std::string const> const first = cache.normalize("SELECT a FROM t WHERE id = 1");
+    TEST_CHECK(cache.normalize("SELECT a FROM t WHERE id = 2") == first);
+    TEST_CHECK(cache.size() == 1);
+
+    cache.normalize("SELECT b FROM t WHERE id = 1");
+    cache.normalize("SELECT c FROM t WHERE id = 1"); // evicts the least recently used shape "SELECT a ..."
+    TEST_CHECK(cache.size() == 2);
+    std::shared_ptr<std::string const> const again = cache.normalize("SELECT a FROM t WHERE id = 3");
+    TEST_CHECK(again != first);
+    TEST_CHECK(*again == *first);
+}
+
+void test_create_tracer(test::standin_agent const& agent) {
+    agent.clear();
+    onesdk_databaseinfo_handle_t const db_info = onesdk_databaseinfo_create(onesdk_asciistr("db"),
+        onesdk_asciistr(ONESDK_DATABASE_VENDOR_POSTGRESQL), ONESDK_CHANNEL_TYPE_TCP_IP, onesdk_asciistr("localhost:5432"));
+    onesdk::sql_statement_cache cache;
+    {
+        onesdk::database_request_tracer tracer(cache.create_tracer(db_info, "SELECT * FROM users WHERE name = 'alice'"));
+        TEST_CHECK(tracer);
+        tracer.start();
+    }
+    onesdk_databaseinfo_delete(db_info);
+
+    std::vector<std::string> const records = agent.records();
+    TEST_CHECK(records.size() == 1);
+    if (records.size() == 1) {
+        TEST_CHECK(test::contains(records[0], "[\"statement\",\"SELECT * FROM users WHERE name = ?\"]"));
+        TEST_CHECK(!test::contains(records[0], "alice"));
+    }
+    TEST_CHECK(cache.create_tracer(ONESDK_INVALID_HANDLE, "SELECT 1") == ONESDK_INVALID_HANDLE);
+}
+
+} // namespace
+
+int main() {
+    test::standin_agent const agent;
+    onesdk::refresh_agent_state();
+
+    test_literals();
+    test_kept_text();
+    test_cache();
+    test_create_tracer(agent);
+
+    return test::result();
+}
@@ -0,0 +1,135 @@
+/*
+    Copyright 2017-2019 Dynatrace LLC
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+// Tests for the string literal macros and UTF-16 helpers in onesdk_string.h and the C++ string helpers in onesdk_cpp_string.h.
+// Most checks are static_asserts, so this test fails to compile rather than to run if one of them doesn't hold.
+
+#include "test_util.h"
+
+#include "onesdk/onesdk_cpp_string.h"
+
+#include <string>
+
+#include <stdint.h>
+
+namespace {
+
+// Checks that must hold at compile time.
+
+constexpr onesdk_string_t ascii_literal = ONESDK_ASCIISTR_LITERAL("ascii");
+static_assert(ascii_literal.byte_length == 5, "ONESDK_ASCIISTR_LITERAL length");
+static_assert(ascii_literal.ccsid == ONESDK_CCSID_ASCII, "ONESDK_ASCIISTR_LITERAL CCSID");
+
+constexpr onesdk_string_t utf8_literal = ONESDK_UTF8STR_LITERAL("gr\xC3\xBC" "n");
+static_assert(utf8_literal.byte_length == 5, "ONESDK_UTF8STR_LITERAL length (in bytes, concatenated)");
+static_assert(utf8_literal.ccsid == ONESDK_CCSID_UTF8, "ONESDK_UTF8STR_LITERAL CCSID");
+
+static_assert(ONESDK_ASCIISTR_LITERAL("").byte_length == 0, "empty literal");
+
+static_assert(onesdk::asciistr("ascii").byte_length == 5, "onesdk::asciistr length");
+static_assert(onesdk::asciistr("ascii").ccsid == ONESDK_CCSID_ASCII, "onesdk::asciistr CCSID");
+static_assert(onesdk::utf8str("gr\xC3\xBCn").byte_length == 5, "onesdk::utf8str length");
+static_assert(onesdk::utf8str("gr\xC3\xBCn").ccsid == ONESDK_CCSID_UTF8, "onesdk::utf8str CCSID");
+
+// The array overloads stop at the first null character, unlike the literal macros.
+constexpr char padded[16] = "abc";
+static_assert(onesdk::asciistr(padded).byte_length == 3, "onesdk::asciistr stops at the first null character");
+static_assert(onesdk::asciistr("a\0b").byte_length == 1, "onesdk::asciistr stops at an embedded null character");
+static_assert(ONESDK_ASCIISTR_LITERAL("a\0b").byte_length == 3, "ONESDK_ASCIISTR_LITERAL includes embedded null characters");
+
+static_assert(onesdk::utf16str(u"\u00FCber").byte_length == 8, "onesdk::utf16str length (in bytes)");
+static_assert(onesdk::utf16str(u"\u00FCber").ccsid == ONESDK_CCSID_UTF16_NATIVE, "onesdk::utf16str CCSID");
+static_assert(onesdk::utf16str(u"\U0001F600").byte_length == 4, "onesdk::utf16str counts code units, not code points");
+static_assert(onesdk::utf16str(u"").byte_length == 0, "empty UTF-16 literal");
+
+static_assert(ONESDK_CCSID_UTF16_NATIVE == ONESDK_CCSID_UTF16_LE || ONESDK_CCSID_UTF16_NATIVE == ONESDK_CCSID_UTF16_BE,
+    "ONESDK_CCSID_UTF16_NATIVE");
+
+#if defined(ONESDK_CPP_HAS_STRING_VIEW)
+static_assert(onesdk::asciistr(std::string_view("ascii")).byte_length == 5, "onesdk::asciistr(std::string_view) length");
+static_assert(onesdk::utf8str(std::string_view("a\0b", 3)).byte_length == 3, "onesdk::utf8str(std::string_view) uses size()");
+static_assert(onesdk::utf16str(std::u16string_view(u"abc")).byte_length == 6, "onesdk::utf16str(std::u16string_view) length");
+static_assert(onesdk::utf16str(std::u16string_view(u"abc")).ccsid == ONESDK_CCSID_UTF16_NATIVE,
+    "onesdk::utf16str(std::u16string_view) CCSID");
+#endif
+
+bool is_string(onesdk_string_t const& str, void const* data, onesdk_size_t byte_length, onesdk_ccsid_t ccsid) {
+    return str.data == data && str.byte_length == byte_length && str.ccsid == ccsid;
+}
+
+void test_literal_macros() {
+    // The macros must also work where a constant expression isn't needed (and in C, where they call onesdk_str).
+    char const* const literal = "literal";
+    onesdk_string_t const ascii = ONESDK_ASCIISTR_LITERAL("literal");
+    TEST_CHECK(ascii.byte_length == 7);
+    TEST_CHECK(ascii.ccsid == ONESDK_CCSID_ASCII);
+    TEST_CHECK(std::string(static_cast<char const*>(ascii.data), ascii.byte_length) == literal);
+
+    onesdk_string_t const utf8 = ONESDK_UTF8STR_LITERAL("lit" "eral");
+    TEST_CHECK(utf8.byte_length == 7);
+    TEST_CHECK(utf8.ccsid == ONESDK_CCSID_UTF8);
+    TEST_CHECK(std::string(static_cast<char const*>(utf8.data), utf8.byte_length) == literal);
+}
+
+void test_utf16_native() {
+    uint16_t const one = 1;
+    bool const little_endian = *reinterpret_cast<unsigned char const*>(&one) == 1;
+    TEST_CHECK(ONESDK_CCSID_UTF16_NATIVE == (little_endian ? ONESDK_CCSID_UTF16_LE : ONESDK_CCSID_UTF16_BE));
+}
+
+void test_utf16str() {
+    uint16_t const text[] = { 0x00FC, 0x0062, 0xD83D, 0xDE00, 0 };
+    TEST_CHECK(is_string(onesdk_utf16str(text), text, 8, ONESDK_CCSID_UTF16_NATIVE));
+    TEST_CHECK(is_string(onesdk_utf16str(text + 4), text + 4, 0, ONESDK_CCSID_UTF16_NATIVE));
+    TEST_CHECK(onesdk_utf16str(NULL).byte_length == 0);
+
+    char16_t const* const pointer = u"\u00FCber";
+    TEST_CHECK(is_string(onesdk::utf16str(pointer), pointer, 8, ONESDK_CCSID_UTF16_NATIVE));
+    char16_t const* const null_pointer = NULL;
+    TEST_CHECK(onesdk::utf16str(null_pointer).byte_length == 0);
+
+    char16_t buffer[8] = u"ab";
+    TEST_CHECK(is_string(onesdk::utf16str(buffer), buffer, 4, ONESDK_CCSID_UTF16_NATIVE));
+
+    std::u16string const str(u"a\0b", 3);
+    TEST_CHECK(is_string(onesdk::utf16str(str), str.data(), 6, ONESDK_CCSID_UTF16_NATIVE));
+}
+
+void test_cpp_overloads() {
+    std::string const str("a\0b", 3);
+    TEST_CHECK(is_string(onesdk::asciistr(str), str.data(), 3, ONESDK_CCSID_ASCII));
+    TEST_CHECK(is_string(onesdk::utf8str(str), str.data(), 3, ONESDK_CCSID_UTF8));
+
+    char const* const pointer = "pointer";
+    TEST_CHECK(is_string(onesdk::asciistr(pointer), pointer, 7, ONESDK_CCSID_ASCII));
+    TEST_CHECK(is_string(onesdk::utf8str(pointer), pointer, 7, ONESDK_CCSID_UTF8));
+
+    char buffer[16] = "abc";
+    TEST_CHECK(is_string(onesdk::asciistr(buffer), buffer, 3, ONESDK_CCSID_ASCII));
+    buffer[3] = 'd';
+    TEST_CHECK(onesdk::asciistr(buffer).byte_length == 4);
+}
+
+} // namespace
+
+int main() {
+    test_literal_macros();
+    test_utf16_native();
+    test_utf16str();
+    test_cpp_overloads();
+
+    return test::result();
+}
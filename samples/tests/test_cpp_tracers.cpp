@@ -0,0 +1,525 @@
+/*
+    Copyright 2017-2019 Dynatrace LLC
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+// Tests for the C++ tracer guards in onesdk_cpp.h.
+
+#include "test_util.h"
+
+#include "onesdk/onesdk_cpp.h"
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <string.h>
+
+namespace {
+
+void test_guard_records_tracer(test::standin_agent const& agent) {
+    agent.clear();
+    {
+        onesdk::custom_service_tracer tracer(onesdk::asciistr("method"), onesdk::asciistr("Service"));
+        TEST_CHECK(tracer);
+        tracer.start();
+        onesdk::custom_service_tracer child(onesdk::asciistr("child"), onesdk::asciistr("Service"));
+        child.start();
+    }
+    std::vector<std::string> const records = agent.records();
+    TEST_CHECK(records.size() == 2);
+    if (records.size() == 2) {
+        // The child is ended first and linked to the outer tracer.
+        TEST_CHECK(test::field(records[0], "parent_span_id") == test::field(records[1], "span_id"));
+        TEST_CHECK(test::field(records[0], "trace_id") == test::field(records[1], "trace_id"));
+    }
+    TEST_CHECK(agent.counters().misuses == 0);
+}
+
+void test_error_from_current_exception(test::standin_agent const& agent) {
+    agent.clear();
+    {
+        onesdk::custom_service_tracer tracer(onesdk::asciistr("method"), onesdk::asciistr("Service"));
+        tracer.start();
+        try {
+            throw std::runtime_error("simulated error");
+        } catch (...) {
+            tracer.error_from_current_exception();
+        }
+    }
+    std::vector<std::string> const records = agent.records();
+    TEST_CHECK(records.size() == 1);
+    if (records.size() == 1) {
+        TEST_CHECK(test::contains(records[0], "\"error_class\":\"std::exception\""));
+        TEST_CHECK(test::contains(records[0], "\"error_message\":\"simulated error\""));
+    }
+}
+
+void test_move(test::standin_agent const& agent) {
+    agent.clear();
+    {
+        onesdk::custom_service_tracer first(onesdk::asciistr("first"), onesdk::asciistr("Service"));
+        first.start();
+        onesdk::custom_service_tracer moved(std::move(first));
+        TEST_CHECK(!first);
+        TEST_CHECK(moved);
+        TEST_CHECK(agent.counters().tracers_ended == 0);
+
+        // Move-assignment ends the tracer the target owned.
+        onesdk::custom_service_tracer second(onesdk::asciistr("second"), onesdk::asciistr("Service"));
+        second.start();
+        moved = std::move(second);
+        TEST_CHECK(agent.counters().tracers_ended == 1);
+    }
+    TEST_CHECK(agent.counters().tracers_ended == 2);
+    TEST_CHECK(agent.counters().misuses == 0);
+}
+
+void test_empty_guard_does_not_call_sdk(test::standin_agent const& agent) {
+    agent.clear();
+    char string_tag[ONESDK_DYNATRACE_STRING_TAG_BUFFER_SIZE];
+    {
+        onesdk::outgoing_remote_call_tracer tracer;
+        TEST_CHECK(!tracer);
+        tracer.set_protocol_name(onesdk::asciistr("protocol"));
+        tracer.start();
+        tracer.error(onesdk::asciistr("class"), onesdk::asciistr("message"));
+
+        string_tag[0] = 'x';
+        onesdk_size_t required_size = 42;
+        TEST_CHECK(tracer.get_outgoing_dynatrace_string_tag(string_tag, sizeof(string_tag), &required_size) == 0);
+        TEST_CHECK(string_tag[0] == '\0');
+        TEST_CHECK(required_size == 0);
+        TEST_CHECK(tracer.get_outgoing_dynatrace_string_tag(string_tag) == 0);
+
+        unsigned char byte_tag[ONESDK_DYNATRACE_BYTE_TAG_BUFFER_SIZE];
+        required_size = 42;
+        TEST_CHECK(tracer.get_outgoing_dynatrace_byte_tag(byte_tag, sizeof(byte_tag), &required_size) == 0);
+        TEST_CHECK(required_size == 0);
+        TEST_CHECK(tracer.get_outgoing_dynatrace_byte_tag(byte_tag) == 0);
+
+        tracer.end();
+    }
+    TEST_CHECK(agent.counters().tracers_created == 0);
+    TEST_CHECK(agent.counters().misuses == 0);
+}
+
+std::vector<onesdk_size_t>& sink_batches() {
+    static std::vector<onesdk_size_t> batches;
+    return batches;
+}
+
+std::vector<std::string>& sink_names() {
+    static std::vector<std::string> names;
+    return names;
+}
+
+void ONESDK_CALL record_batch(onesdk_tracer_handle_t, onesdk_string_t const* names, onesdk_string_t const*, onesdk_size_t count) {
+    sink_batches().push_back(count);
+    for (onesdk_size_t i = 0; i < count; i++)
+        sink_names().push_back(std::string(static_cast<char const*>(names[i].data), names[i].byte_length));
+}
+
+void test_name_value_sink_batches() {
+    std::vector<std::string> names;
+    for (int i = 0; i < 40; i++)
+        names.push_back("n" + std::to_string(i));
+    {
+        onesdk::name_value_sink sink(record_batch, 1);
+        for (std::size_t i = 0; i < names.size(); i++)
+            sink.add(onesdk::asciistr(names[i]), onesdk::asciistr("v"));
+        // Full batches are passed right away, the rest when the sink is destroyed.
+        TEST_CHECK(sink_batches().size() == 2);
+    }
+    TEST_CHECK(sink_batches() == std::vector<onesdk_size_t>({ 16, 16, 8 }));
+    TEST_CHECK(sink_names() == names);
+}
+
+std::string name_value_attributes(char const* prefix, int count) {
+    std::string attributes;
+    for (int i = 0; i < count; i++) {
+        if (i != 0)
+            attributes += ",";
+        attributes += "[\"" + std::string(prefix) + "n" + std::to_string(i) + "\",\"v" + std::to_string(i) + "\"]";
+    }
+    return attributes;
+}
+
+void test_web_request_pairs_from(test::standin_agent const& agent) {
+    std::vector<std::string> names;
+    std::vector<std::string> values;
+    for (int i = 0; i < 20; i++) {
+        names.push_back("n" + std::to_string(i));
+        values.push_back("v" + std::to_string(i));
+    }
+    auto const produce = [&](std::size_t count) {
+        return [&names, &values, count](onesdk::name_value_sink& sink) {
+            for (std::size_t i = 0; i < count; i++)
+                sink.add(onesdk::asciistr(names[i]), onesdk::asciistr(values[i]));
+        };
+    };
+
+    agent.clear();
+    onesdk_webapplicationinfo_handle_t const web_application = onesdk_webapplicationinfo_create(onesdk_asciistr("server"),
+        onesdk_asciistr("app"), onesdk_asciistr("/"));
+    {
+        onesdk::incoming_web_request_tracer tracer(web_application, onesdk::asciistr("/path"), onesdk::asciistr("GET"));
+        tracer.add_request_headers_from(produce(20));
+        tracer.add_parameters_from(produce(16));
+        tracer.start();
+        tracer.add_response_headers_from(produce(17));
+    }
+    {
+        onesdk::outgoing_web_request_tracer tracer(onesdk::asciistr("http://host/path"), onesdk::asciistr("GET"));
+        tracer.add_request_headers_from(produce(18));
+        tracer.start();
+        tracer.add_response_headers_from(produce(3));
+    }
+    onesdk_webapplicationinfo_delete(web_application);
+
+    std::vector<std::string> const records = agent.records();
+    TEST_CHECK(records.size() == 2);
+    if (records.size() == 2) {
+        TEST_CHECK(test::contains(records[0], name_value_attributes("request_header.", 20) + "," +
+            name_value_attributes("parameter.", 16) + "," + name_value_attributes("response_header.", 17)));
+        TEST_CHECK(test::contains(records[1], name_value_attributes("request_header.", 18) + "," +
+            name_value_attributes("response_header.", 3)));
+    }
+    TEST_CHECK(agent.counters().misuses == 0);
+}
+
+void test_pairs_from_empty_guard() {
+    bool called = false;
+    auto const producer = [&called](onesdk::name_value_sink&) { called = true; };
+
+    onesdk::incoming_web_request_tracer incoming;
+    incoming.add_request_headers_from(producer);
+    incoming.add_parameters_from(producer);
+    incoming.add_response_headers_from(producer);
+    onesdk::outgoing_web_request_tracer outgoing;
+    outgoing.add_request_headers_from(producer);
+    outgoing.add_response_headers_from(producer);
+    TEST_CHECK(!called);
+
+    // Guards created while the cached state is inactive are empty, too.
+    onesdk::detail::agent_state_cache& cache = onesdk::detail::agent_state_storage();
+    cache.state.store(ONESDK_AGENT_STATE_TEMPORARILY_INACTIVE);
+    cache.inactive.store(true);
+    {
+        onesdk::outgoing_web_request_tracer tracer(onesdk::asciistr("http://host/path"), onesdk::asciistr("GET"));
+        TEST_CHECK(!tracer);
+        tracer.add_request_headers_from(producer);
+        tracer.add_response_headers_from(producer);
+    }
+    onesdk::refresh_agent_state();
+    TEST_CHECK(!called);
+}
+
+void test_stale_inactive_cache(test::standin_agent const& agent) {
+    // Simulate a refresh that saw an inactive agent which has become active since.
+    onesdk::detail::agent_state_cache& cache = onesdk::detail::agent_state_storage();
+    cache.state.store(ONESDK_AGENT_STATE_TEMPORARILY_INACTIVE);
+    cache.inactive.store(true);
+    TEST_CHECK(onesdk_agent_get_current_state() == ONESDK_AGENT_STATE_ACTIVE);
+
+    agent.clear();
+    {
+        onesdk::custom_service_tracer tracer(onesdk::asciistr("method"), onesdk::asciistr("Service"));
+        TEST_CHECK(!tracer);
+        tracer.start();
+    }
+    TEST_CHECK(agent.counters().tracers_created == 0);
+
+    // The guards only create tracers again after the next refresh.
+    TEST_CHECK(onesdk::refresh_agent_state() == ONESDK_AGENT_STATE_ACTIVE);
+    TEST_CHECK(onesdk::agent_active());
+    {
+        onesdk::custom_service_tracer tracer(onesdk::asciistr("method"), onesdk::asciistr("Service"));
+        TEST_CHECK(tracer);
+        tracer.start();
+    }
+    TEST_CHECK(agent.counters().tracers_created == 1);
+    TEST_CHECK(agent.records().size() == 1);
+}
+
+void test_outgoing_tag(test::standin_agent const& agent) {
+    agent.clear();
+    onesdk::outgoing_remote_call_tracer tracer(onesdk::asciistr("method"), onesdk::asciistr("Service"), onesdk::asciistr("endpoint"),
+        ONESDK_CHANNEL_TYPE_TCP_IP, onesdk::asciistr("localhost:1234"));
+    tracer.start();
+
+    char string_tag[ONESDK_DYNATRACE_STRING_TAG_BUFFER_SIZE];
+    onesdk_size_t required_size = 0;
+    onesdk_size_t const size = tracer.get_outgoing_dynatrace_string_tag(string_tag, sizeof(string_tag), &required_size);
+    TEST_CHECK(size != 0);
+    TEST_CHECK(size == strlen(string_tag));
+    TEST_CHECK(required_size == size + 1);
+    TEST_CHECK(tracer.get_outgoing_dynatrace_string_tag(string_tag) == size);
+
+    // A buffer that is too small receives an empty tag, the required size tells how big a buffer for a second attempt must be.
+    char small_buffer[8];
+    required_size = 0;
+    TEST_CHECK(tracer.get_outgoing_dynatrace_string_tag(small_buffer, &required_size) == 0);
+    TEST_CHECK(small_buffer[0] == '\0');
+    TEST_CHECK(required_size == size + 1);
+}
+
+void test_in_process_link(test::standin_agent const& agent) {
+    TEST_CHECK(onesdk::in_process_link::current().empty()); // No active tracer.
+
+    agent.clear();
+    {
+        onesdk::custom_service_tracer tracer(onesdk::asciistr("method"), onesdk::asciistr("Service"));
+        tracer.start();
+        onesdk::in_process_link const link = onesdk::in_process_link::current();
+        TEST_CHECK(!link.empty());
+        onesdk::in_process_link copy;
+        copy = link;
+        TEST_CHECK(copy.size() == link.size());
+        TEST_CHECK(memcmp(copy.data(), link.data(), static_cast<size_t>(link.size())) == 0);
+
+        onesdk::in_process_link_tracer link_tracer(copy);
+        TEST_CHECK(link_tracer);
+        link_tracer.start();
+    }
+    std::vector<std::string> const records = agent.records();
+    TEST_CHECK(records.size() == 2);
+    if (records.size() == 2) {
+        TEST_CHECK(test::field(records[0], "type") == "inprocess_link");
+        TEST_CHECK(test::field(records[0], "parent_span_id") == test::field(records[1], "span_id"));
+    }
+}
+
+void test_request_context_destructor_detaches(test::standin_agent const& agent) {
+    agent.clear();
+    {
+        onesdk::custom_service_tracer request(onesdk::asciistr("request"), onesdk::asciistr("Service"));
+        request.start();
+        {
+            onesdk::request_context context = onesdk::request_context::capture();
+            context.attach();
+            TEST_CHECK(context.attached());
+        }
+        TEST_CHECK(agent.counters().tracers_ended == 1);
+
+        // The request tracer is the active tracer again.
+        onesdk::custom_service_tracer child(onesdk::asciistr("child"), onesdk::asciistr("Service"));
+        child.start();
+    }
+    std::vector<std::string> const records = agent.records();
+    TEST_CHECK(records.size() == 3);
+    if (records.size() == 3)
+        TEST_CHECK(test::field(records[1], "parent_span_id") == test::field(records[2], "span_id"));
+    TEST_CHECK(agent.counters().misuses == 0);
+}
+
+void test_custom_request_attribute_batch(test::standin_agent const& agent) {
+    agent.clear();
+    std::vector<std::string> keys;
+    for (int i = 0; i < 20; i++)
+        keys.push_back("i" + std::to_string(i));
+
+    std::vector<onesdk_customrequestattribute_t> attributes(5 + keys.size());
+    memset(attributes.data(), 0, attributes.size() * sizeof(attributes[0]));
+    attributes[0].key = onesdk::asciistr("a");
+    attributes[0].type = ONESDK_CUSTOM_REQUEST_ATTRIBUTE_TYPE_INTEGER;
+    attributes[0].integer_value = 1;
+    attributes[1].key = onesdk::asciistr("ignored");
+    attributes[1].type = 42; // Unknown types are ignored.
+    attributes[2].key = onesdk::asciistr("b");
+    attributes[2].type = ONESDK_CUSTOM_REQUEST_ATTRIBUTE_TYPE_STRING;
+    attributes[2].string_value = onesdk::asciistr("x");
+    attributes[3].key = onesdk::asciistr("c");
+    attributes[3].type = ONESDK_CUSTOM_REQUEST_ATTRIBUTE_TYPE_INTEGER;
+    attributes[3].integer_value = 2;
+    attributes[4].key = onesdk::asciistr("d");
+    attributes[4].type = ONESDK_CUSTOM_REQUEST_ATTRIBUTE_TYPE_FLOAT;
+    attributes[4].float_value = 0.5;
+    // More than 16 attributes of the same type in a row are split into several calls.
+    std::string expected = "\"request_attributes\":[[\"a\",\"1\"],[\"b\",\"x\"],[\"c\",\"2\"],[\"d\",\"0.5\"]";
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        attributes[5 + i].key = onesdk::asciistr(keys[i]);
+        attributes[5 + i].type = ONESDK_CUSTOM_REQUEST_ATTRIBUTE_TYPE_INTEGER;
+        attributes[5 + i].integer_value = static_cast<onesdk_int64_t>(i);
+        expected += ",[\"" + keys[i] + "\",\"" + std::to_string(i) + "\"]";
+    }
+    expected += "]";
+
+    {
+        onesdk::custom_service_tracer tracer(onesdk::asciistr("method"), onesdk::asciistr("Service"));
+        tracer.start();
+        onesdk_customrequestattribute_add_batch(attributes.data(), attributes.size());
+    }
+    std::vector<std::string> const records = agent.records();
+    TEST_CHECK(records.size() == 1);
+    if (records.size() == 1)
+        TEST_CHECK(test::contains(records[0], expected));
+    TEST_CHECK(agent.counters().request_attributes == 24);
+}
+
+void test_timed_without_tracer_ext(test::standin_agent const& agent) {
+    // Without onesdk_ex_api_enable_tracer_ext the tracers are started with the current time and must be ended by onesdk_tracer_end.
+    onesdk_int64_t const now = onesdk::to_timestamp(std::chrono::steady_clock::now());
+    agent.clear();
+    onesdk_tracer_handle_t const tracer = onesdk_customservicetracer_create(onesdk_asciistr("method"), onesdk_asciistr("Service"));
+    TEST_CHECK(onesdk_tracer_start_timed(tracer, 1500000000000000) == 0);
+    onesdk_tracer_end(tracer);
+
+    {
+        std::chrono::steady_clock::time_point const start_time = std::chrono::steady_clock::now() - std::chrono::hours(1);
+        onesdk::custom_service_tracer guard(onesdk::asciistr("method"), onesdk::asciistr("Service"));
+        guard.start(start_time);
+        guard.end(start_time + std::chrono::seconds(1));
+        TEST_CHECK(!guard);
+    }
+
+    std::vector<std::string> const records = agent.records();
+    TEST_CHECK(records.size() == 2);
+    for (std::size_t i = 0; i < records.size(); i++) {
+        TEST_CHECK(std::stoll(test::number_field(records[i], "start_time")) >= now);
+        TEST_CHECK(std::stoll(test::number_field(records[i], "end_time")) >= now);
+    }
+    TEST_CHECK(agent.counters().tracers_ended == 2);
+    TEST_CHECK(agent.counters().misuses == 0);
+}
+
+void test_timed(test::standin_agent const& agent) {
+    agent.clear();
+    onesdk_tracer_handle_t const tracer = onesdk_customservicetracer_create(onesdk_asciistr("method"), onesdk_asciistr("Service"));
+    TEST_CHECK(onesdk_tracer_start_timed(tracer, 1500000000000000) != 0);
+    onesdk_tracer_end_timed(tracer, 1500000000000042);
+
+    std::chrono::steady_clock::time_point const start_time = std::chrono::steady_clock::now() - std::chrono::seconds(10);
+    std::chrono::steady_clock::time_point const end_time = start_time + std::chrono::microseconds(1234);
+    {
+        onesdk::custom_service_tracer guard(onesdk::asciistr("method"), onesdk::asciistr("Service"));
+        guard.start(start_time);
+        guard.end(end_time);
+    }
+
+    std::vector<std::string> const records = agent.records();
+    TEST_CHECK(records.size() == 2);
+    if (records.size() == 2) {
+        TEST_CHECK(test::number_field(records[0], "start_time") == "1500000000000000");
+        TEST_CHECK(test::number_field(records[0], "end_time") == "1500000000000042");
+        TEST_CHECK(test::number_field(records[1], "start_time") == std::to_string(onesdk::to_timestamp(start_time)));
+        TEST_CHECK(test::number_field(records[1], "end_time") == std::to_string(onesdk::to_timestamp(end_time)));
+    }
+    TEST_CHECK(agent.counters().tracers_ended == 2);
+    TEST_CHECK(agent.counters().misuses == 0);
+}
+
+// Starts a child of parent while another tracer is the active tracer, and returns the result of the start function.
+onesdk_bool_t start_child_of_inactive_parent(bool timed) {
+    onesdk_tracer_handle_t const parent = onesdk_customservicetracer_create(onesdk_asciistr("parent"), onesdk_asciistr("Service"));
+    onesdk_tracer_start(parent);
+    onesdk_tracer_handle_t const active = onesdk_customservicetracer_create(onesdk_asciistr("active"), onesdk_asciistr("Service"));
+    onesdk_tracer_start(active);
+
+    onesdk_tracer_handle_t const child = onesdk_customservicetracer_create(onesdk_asciistr("child"), onesdk_asciistr("Service"));
+    onesdk_bool_t const result = timed
+        ? onesdk_tracer_start_timed_with_parent(child, parent, 1500000000000000)
+        : onesdk_tracer_start_with_parent(child, parent);
+    if (timed && result)
+        onesdk_tracer_end_timed(child, 1500000000000042);
+    else
+        onesdk_tracer_end(child);
+
+    onesdk_tracer_end(active);
+    onesdk_tracer_end(parent);
+    return result;
+}
+
+void test_start_with_parent_without_tracer_ext(test::standin_agent const& agent) {
+    // Without onesdk_ex_api_enable_tracer_ext the explicit parent is ignored and the tracer is started by onesdk_tracer_start.
+    for (int timed = 0; timed < 2; timed++) {
+        agent.clear();
+        TEST_CHECK(start_child_of_inactive_parent(timed != 0) == 0);
+        std::vector<std::string> const records = agent.records();
+        TEST_CHECK(records.size() == 3);
+        if (records.size() == 3) {
+            TEST_CHECK(test::field(records[0], "parent_span_id") == test::field(records[1], "span_id"));
+            TEST_CHECK(test::number_field(records[0], "start_time") != "1500000000000000");
+        }
+        TEST_CHECK(agent.counters().tracers_ended == 3);
+        TEST_CHECK(agent.counters().misuses == 0);
+    }
+}
+
+void test_start_with_parent(test::standin_agent const& agent) {
+    // The explicit parent wins over the active tracer of the thread.
+    for (int timed = 0; timed < 2; timed++) {
+        agent.clear();
+        TEST_CHECK(start_child_of_inactive_parent(timed != 0) != 0);
+        std::vector<std::string> const records = agent.records();
+        TEST_CHECK(records.size() == 3);
+        if (records.size() == 3) {
+            TEST_CHECK(test::field(records[0], "parent_span_id") == test::field(records[2], "span_id"));
+            TEST_CHECK(test::field(records[0], "trace_id") == test::field(records[2], "trace_id"));
+            TEST_CHECK(test::field(records[1], "parent_span_id") == test::field(records[2], "span_id"));
+            if (timed) {
+                TEST_CHECK(test::number_field(records[0], "start_time") == "1500000000000000");
+                TEST_CHECK(test::number_field(records[0], "end_time") == "1500000000000042");
+            }
+        }
+        TEST_CHECK(agent.counters().misuses == 0);
+    }
+
+    // The C++ guard passes the parent's handle.
+    agent.clear();
+    {
+        onesdk::custom_service_tracer parent(onesdk::asciistr("parent"), onesdk::asciistr("Service"));
+        parent.start();
+        onesdk::custom_service_tracer active(onesdk::asciistr("active"), onesdk::asciistr("Service"));
+        active.start();
+        onesdk::custom_service_tracer child(onesdk::asciistr("child"), onesdk::asciistr("Service"));
+        child.start_with_parent(parent);
+    }
+    std::vector<std::string> const records = agent.records();
+    TEST_CHECK(records.size() == 3);
+    if (records.size() == 3)
+        TEST_CHECK(test::field(records[0], "parent_span_id") == test::field(records[2], "span_id"));
+    TEST_CHECK(agent.counters().misuses == 0);
+}
+
+} // namespace
+
+int main() {
+    test::standin_agent const agent;
+    onesdk::refresh_agent_state();
+
+    // Enabling the extended tracer functions can't be undone, so the tests of the fallback run first.
+    test_timed_without_tracer_ext(agent);
+    test_start_with_parent_without_tracer_ext(agent);
+    onesdk_ex_api_enable_tracer_ext();
+
+    test_guard_records_tracer(agent);
+    test_error_from_current_exception(agent);
+    test_move(agent);
+    test_empty_guard_does_not_call_sdk(agent);
+    test_stale_inactive_cache(agent);
+    test_name_value_sink_batches();
+    test_web_request_pairs_from(agent);
+    test_pairs_from_empty_guard();
+    test_outgoing_tag(agent);
+    test_in_process_link(agent);
+    test_request_context_destructor_detaches(agent);
+    test_custom_request_attribute_batch(agent);
+    test_timed(agent);
+    test_start_with_parent(agent);
+
+    return test::result();
+}
@@ -0,0 +1,128 @@
+/*
+    Copyright 2017-2019 Dynatrace LLC
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+// Tests that the stand-in agent recycles its tracers, attribute strings and records: running the same tracer workload a second time
+// must not allocate, also if strings are passed as Latin-1 or UTF-16.
+
+#include "test_util.h"
+
+#include "onesdk/onesdk_cpp.h"
+
+#include <new>
+
+#include <stdlib.h>
+
+/*========================================================================================================================================*/
+// Allocation counting. Replacing the global operator new also counts allocations made by C++ code in the agent module.
+
+namespace {
+unsigned long long g_allocations = 0;
+}
+
+void* operator new(std::size_t size) {
+    g_allocations++;
+    void* const p = malloc(size ? size : 1);
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept {
+    g_allocations++;
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept {
+    g_allocations++;
+    return malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+/*========================================================================================================================================*/
+
+namespace {
+
+// Text with non-ASCII characters (and a surrogate pair in the UTF-16 text), so that both are converted to UTF-8 by the agent. Both are
+// too long for the small string optimization, so a temporary copy would allocate.
+char const latin1_text[] = "Sch\xF6ne Gr\xFC\xDF" "e aus M\xFCnchen";
+char16_t const utf16_text[] = u"Sch\u00F6ne Gr\u00FC\u00DFe aus M\u00FCnchen \U0001F600";
+
+void run_workload(onesdk_webapplicationinfo_handle_t web_application) {
+    onesdk_string_t const latin1 = onesdk_str(latin1_text, sizeof(latin1_text) - 1, ONESDK_CCSID_ISO8859_1);
+    onesdk_string_t const utf16 = onesdk::utf16str(utf16_text);
+
+    for (int i = 0; i < 4; i++) {
+        onesdk::incoming_web_request_tracer request(web_application, onesdk::asciistr("/path"), onesdk::asciistr("GET"));
+        request.add_request_headers_from([&](onesdk::name_value_sink& sink) {
+            for (int j = 0; j < 20; j++)
+                sink.add(latin1, utf16);
+        });
+        request.start();
+
+        onesdk::custom_service_tracer child(latin1, utf16);
+        child.start();
+        child.error(utf16, latin1);
+        child.end();
+
+        onesdk::outgoing_web_request_tracer outgoing(utf16, onesdk::asciistr("POST"));
+        outgoing.add_request_header(onesdk::asciistr("Content-Type"), latin1);
+        outgoing.start();
+    }
+}
+
+void test_second_pass_does_not_allocate(test::standin_agent const& agent) {
+    onesdk_webapplicationinfo_handle_t const web_application = onesdk_webapplicationinfo_create(onesdk_asciistr("server"),
+        onesdk_asciistr("app"), onesdk_asciistr("/"));
+
+    agent.clear();
+    run_workload(web_application);
+    TEST_CHECK(agent.counters().tracers_ended == 12);
+    TEST_CHECK(agent.counters().tracers_allocated != 0);
+
+    agent.clear();
+    unsigned long long const allocations_before = g_allocations;
+    run_workload(web_application);
+    unsigned long long const allocations = g_allocations - allocations_before;
+
+    onesdk_webapplicationinfo_delete(web_application);
+    TEST_CHECK(allocations == 0);
+    TEST_CHECK(agent.counters().tracers_ended == 12);
+    TEST_CHECK(agent.counters().tracers_allocated == 0);
+    TEST_CHECK(agent.counters().misuses == 0);
+    TEST_CHECK(agent.records().size() == 12);
+}
+
+} // namespace
+
+int main() {
+    test::standin_agent const agent;
+    onesdk::refresh_agent_state();
+
+    test_second_pass_does_not_allocate(agent);
+
+    return test::result();
+}
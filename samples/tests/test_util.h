@@ -0,0 +1,149 @@
+/*
+    Copyright 2017-2019 Dynatrace LLC
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef TEST_UTIL_H_INCLUDED
+#define TEST_UTIL_H_INCLUDED
+
+// Helpers shared by the tests. Every test is a separate executable that runs the SDK against the stand-in agent from
+// samples/standin_agent, checks the records and counters it produced and exits with a non-zero status if a check failed.
+
+#include "onesdk/onesdk.h"
+#include "../standin_agent/standin_agent.h"
+
+#include <string>
+#include <vector>
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if !defined(TEST_STANDIN_AGENT)
+#    error TEST_STANDIN_AGENT must be defined as the path of the stand-in agent module.
+#endif
+
+namespace test {
+
+inline int& failure_count() {
+    static int count = 0;
+    return count;
+}
+
+inline void check(bool condition, char const* expression, char const* file, int line) {
+    if (!condition) {
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        failure_count()++;
+    }
+}
+
+#define TEST_CHECK(condition) ::test::check(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
+
+// Initializes the SDK with the stand-in agent on construction and shuts it down on destruction.
+class standin_agent {
+public:
+    explicit standin_agent(char const* options = NULL) : m_initialized(false), m_module(NULL) {
+        onesdk_stub_set_variable("agentlibrary=" TEST_STANDIN_AGENT, 0);
+        if (options != NULL)
+            onesdk_stub_set_variable(options, 0);
+        if (onesdk_initialize() != ONESDK_SUCCESS) {
+            fprintf(stderr, "SDK initialization with the stand-in agent failed\n");
+            exit(1);
+        }
+        m_initialized = true;
+        m_module = dlopen(TEST_STANDIN_AGENT, RTLD_NOW | RTLD_NOLOAD);
+        m_get_counters = reinterpret_cast<onesdk_standin_get_counters_t*>(dlsym(m_module, "onesdk_standin_get_counters"));
+        m_visit_records = reinterpret_cast<onesdk_standin_visit_records_t*>(dlsym(m_module, "onesdk_standin_visit_records"));
+        m_clear = reinterpret_cast<onesdk_standin_clear_t*>(dlsym(m_module, "onesdk_standin_clear"));
+        if (m_get_counters == NULL || m_visit_records == NULL || m_clear == NULL) {
+            fprintf(stderr, "the stand-in agent module doesn't export its query functions\n");
+            exit(1);
+        }
+    }
+
+    ~standin_agent() {
+        if (m_module != NULL)
+            dlclose(m_module);
+        if (m_initialized)
+            onesdk_shutdown();
+    }
+
+    onesdk_standin_counters_t counters() const {
+        onesdk_standin_counters_t c;
+        m_get_counters(&c);
+        return c;
+    }
+
+    // Returns the tracer records in the order the tracers were ended (followed by metric records, if any).
+    std::vector<std::string> records() const {
+        std::vector<std::string> result;
+        m_visit_records(&append_record, &result);
+        return result;
+    }
+
+    void clear() const {
+        m_clear();
+    }
+
+private:
+    standin_agent(standin_agent const&);
+    standin_agent& operator =(standin_agent const&);
+
+    static void ONESDK_CALL append_record(char const* record, void* context) {
+        static_cast<std::vector<std::string>*>(context)->push_back(record);
+    }
+
+    bool m_initialized;
+    void* m_module;
+    onesdk_standin_get_counters_t* m_get_counters;
+    onesdk_standin_visit_records_t* m_visit_records;
+    onesdk_standin_clear_t* m_clear;
+};
+
+// Returns true if record contains "needle".
+inline bool contains(std::string const& record, std::string const& needle) {
+    return record.find(needle) != std::string::npos;
+}
+
+// Returns the value of the first "key":"value" string field in a JSON record, or an empty string.
+inline std::string field(std::string const& record, std::string const& key) {
+    std::string const prefix = "\"" + key + "\":\"";
+    std::string::size_type const begin = record.find(prefix);
+    if (begin == std::string::npos)
+        return std::string();
+    std::string::size_type const value_begin = begin + prefix.size();
+    return record.substr(value_begin, record.find('"', value_begin) - value_begin);
+}
+
+// Returns the text of the first "key":number field in a JSON record, or an empty string.
+inline std::string number_field(std::string const& record, std::string const& key) {
+    std::string const prefix = "\"" + key + "\":";
+    std::string::size_type const begin = record.find(prefix);
+    if (begin == std::string::npos)
+        return std::string();
+    std::string::size_type const value_begin = begin + prefix.size();
+    return record.substr(value_begin, record.find_first_not_of("-0123456789", value_begin) - value_begin);
+}
+
+inline int result() {
+    if (failure_count() != 0) {
+        fprintf(stderr, "%d check(s) failed\n", failure_count());
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace test
+
+#endif /* TEST_UTIL_H_INCLUDED */